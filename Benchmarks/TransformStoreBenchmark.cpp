@@ -0,0 +1,129 @@
+#include "../Source/Core/TransformStore.h"
+#include "../Source/Core/Components/TransformComponent.h"
+#include "../Source/Infrastructure/Jobs/JobSystem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+// Compares per entity glm composition of TransformComponent::GetTransform with batched TransformStore composition.
+// Every iteration changes all transforms, the same as a scene where every body moves during each physics step
+
+namespace
+{
+	constexpr int IterationsCount = 10;
+	constexpr size_t EntitiesCounts[] = { 1000, 100000, 1000000 };
+
+	struct TransformValues
+	{
+		glm::vec3 Translation;
+		glm::vec3 Rotation;
+		glm::vec3 Scale;
+	};
+
+	std::vector<TransformValues> GenerateValues(size_t count)
+	{
+		// Fixed seed, so every run composes the same transforms
+		std::mt19937 generator(42);
+		std::uniform_real_distribution<float> translation(-1000.0f, 1000.0f);
+		std::uniform_real_distribution<float> rotation(-360.0f, 360.0f);
+		std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+
+		std::vector<TransformValues> values(count);
+		for (auto& value : values)
+		{
+			value.Translation = glm::vec3(translation(generator), translation(generator), translation(generator));
+			value.Rotation = glm::vec3(rotation(generator), rotation(generator), rotation(generator));
+			value.Scale = glm::vec3(scale(generator), scale(generator), scale(generator));
+		}
+		return values;
+	}
+
+	// Average milliseconds per iteration. First run is not measured, so allocations made by it aren't counted
+	template<typename Func>
+	double Measure(Func func)
+	{
+		func(0);
+		const auto start = std::chrono::steady_clock::now();
+		for (int iteration = 1; iteration <= IterationsCount; iteration++)
+		{
+			func(iteration);
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		return std::chrono::duration<double, std::milli>(elapsed).count() / IterationsCount;
+	}
+
+	double MeasureComponents(const std::vector<TransformValues>& values, float& checksum)
+	{
+		std::vector<Mango::TransformComponent> transforms(values.size());
+		return Measure([&](int iteration)
+		{
+			const glm::vec3 offset(static_cast<float>(iteration), 0.0f, 0.0f);
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				auto& transform = transforms[i];
+				transform.SetTranslation(values[i].Translation + offset);
+				transform.SetRotation(values[i].Rotation);
+				transform.SetScale(values[i].Scale);
+				checksum += transform.GetTransform()[3][0];
+			}
+		});
+	}
+
+	double MeasureStore(const std::vector<TransformValues>& values, float& checksum)
+	{
+		Mango::TransformStore store;
+		store.Reserve(values.size());
+		return Measure([&](int iteration)
+		{
+			const glm::vec3 offset(static_cast<float>(iteration), 0.0f, 0.0f);
+			store.Clear();
+			for (const auto& value : values)
+			{
+				store.Add(value.Translation + offset, value.Rotation, value.Scale);
+			}
+			store.Compose();
+			for (size_t i = 0; i < store.GetSize(); i++)
+			{
+				checksum += store.GetTransform(i)[3][0];
+			}
+		});
+	}
+}
+
+int main()
+{
+	std::printf("TransformStore composes %zu transforms per kernel iteration, %d iterations per measurement\n", Mango::TransformStore::GetBatchSize(), IterationsCount);
+	std::printf("%10s %16s %16s %16s\n", "Entities", "Component ms", "Store ms", "Store jobs ms");
+
+	// Results are summed and printed, so composition can't be optimized away
+	float checksum = 0.0f;
+	double componentTimes[std::size(EntitiesCounts)];
+	double storeTimes[std::size(EntitiesCounts)];
+	double storeJobsTimes[std::size(EntitiesCounts)];
+
+	// Without initialized job system store composes everything on the calling thread
+	for (size_t i = 0; i < std::size(EntitiesCounts); i++)
+	{
+		const auto values = GenerateValues(EntitiesCounts[i]);
+		componentTimes[i] = MeasureComponents(values, checksum);
+		storeTimes[i] = MeasureStore(values, checksum);
+	}
+
+	Mango::JobSystem::Initialize();
+	for (size_t i = 0; i < std::size(EntitiesCounts); i++)
+	{
+		const auto values = GenerateValues(EntitiesCounts[i]);
+		storeJobsTimes[i] = MeasureStore(values, checksum);
+	}
+	Mango::JobSystem::Shutdown();
+
+	for (size_t i = 0; i < std::size(EntitiesCounts); i++)
+	{
+		std::printf("%10zu %16.3f %16.3f %16.3f\n", EntitiesCounts[i], componentTimes[i], storeTimes[i], storeJobsTimes[i]);
+	}
+	std::printf("Checksum %f\n", checksum);
+	return 0;
+}
@@ -3,12 +3,18 @@
 #include "Core/SceneManager.h"
 #include "Infrastructure/Assert/Assert.h"
 #include "Infrastructure/Logging/Logging.h"
+#include "Infrastructure/Jobs/JobSystem.h"
 
-const uint32_t _fixedUpdatePerSecond = 60;
-const uint32_t _fixedUpdateStepMillisecond = std::ceil((1.0f / _fixedUpdatePerSecond) * 1000);
+#include <cmath>
+
+// Fixed updates run per frame at most, the rest of lagging time is dropped so simulation can't spiral
+const uint32_t _maxFixedUpdatesPerFrame = 5;
+// Number of frames simulation could run ahead of presentation, 1 or 2
+const uint32_t _maxFrameLatency = 2;
 
 Mango::Application::Application()
 {
+    Mango::JobSystem::Initialize();
     InitializeWindow();
     InitializeVulkan();
 
@@ -18,6 +24,12 @@ Mango::Application::Application()
     _renderingLayer->GetEditor().InitializeSceneForEditor();
 }
 
+Mango::Application::~Application()
+{
+    Mango::SceneManager::Shutdown();
+    Mango::JobSystem::Shutdown();
+}
+
 void Mango::Application::Run()
 {
     RunMainLoop();
@@ -31,7 +43,7 @@ void Mango::Application::InitializeWindow()
 void Mango::Application::InitializeVulkan()
 {
     _vulkanContext = std::make_unique<const Mango::Context>(_window.get());
-    _renderingLayer = std::make_unique<Mango::RenderingLayer_ImplVulkan>(_vulkanContext.get());
+    _renderingLayer = std::make_unique<Mango::RenderingLayer_ImplVulkan>(_vulkanContext.get(), _maxFrameLatency);
 }
 
 void Mango::Application::RunMainLoop()
@@ -47,22 +59,40 @@ void Mango::Application::RunMainLoop()
 
 void Mango::Application::DrawFrame()
 {
+    // Scene loaded in background replaces current one before anything of this frame refers to it
+    if (Mango::SceneManager::SwapLoadedScene())
+    {
+        _renderingLayer->GetEditor().InitializeSceneForEditor();
+    }
+
     if (!_renderingLayer->BeginFrame())
     {
         return;
     }
 
     auto& scene = Mango::SceneManager::GetScene();
-    
-    scene.OnUpdate();
-    
-    auto currentTime = std::chrono::steady_clock::now();
-    auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - _lastOnFixedUpdate);
-    if (timeDiff.count() > _fixedUpdateStepMillisecond)
+
+    const auto currentTime = std::chrono::steady_clock::now();
+    const double deltaTime = std::chrono::duration<double>(currentTime - _lastFrameTime).count();
+    _lastFrameTime = currentTime;
+
+    // Simulation advances in fixed steps of real time, as many as fit into accumulated time
+    const double fixedDeltaTime = scene.GetFixedDeltaTime();
+    _fixedUpdateAccumulator += deltaTime;
+    uint32_t fixedUpdatesCount = 0;
+    while (_fixedUpdateAccumulator >= fixedDeltaTime && fixedUpdatesCount < _maxFixedUpdatesPerFrame)
     {
         scene.OnFixedUpdate();
-        _lastOnFixedUpdate = std::chrono::steady_clock::now();
+        _fixedUpdateAccumulator -= fixedDeltaTime;
+        fixedUpdatesCount++;
     }
+    if (_fixedUpdateAccumulator >= fixedDeltaTime)
+    {
+        _fixedUpdateAccumulator = std::fmod(_fixedUpdateAccumulator, fixedDeltaTime);
+    }
+
+    const double interpolationAlpha = _fixedUpdateAccumulator / fixedDeltaTime;
+    scene.OnUpdate(static_cast<float>(deltaTime), static_cast<float>(interpolationAlpha));
 
     _renderingLayer->EndFrame();
 }
@@ -18,6 +18,7 @@ namespace Mango
         Application();
         Application(const Application&) = delete;
         Application operator=(const Application&) = delete;
+        ~Application();
         
         void Run();
 
@@ -32,6 +33,8 @@ namespace Mango
         std::unique_ptr<const Mango::Context> _vulkanContext;
         std::unique_ptr<Mango::RenderingLayer_ImplVulkan> _renderingLayer;
 
-        std::chrono::steady_clock::time_point _lastOnFixedUpdate = std::chrono::steady_clock::now();
+        // Steady clock is monotonic and has nanosecond resolution on supported platforms
+        std::chrono::steady_clock::time_point _lastFrameTime = std::chrono::steady_clock::now();
+        double _fixedUpdateAccumulator = 0.0;
     };
 }
@@ -0,0 +1,575 @@
+#include "BinarySceneSerializer.h"
+
+#include "Components/Components.h"
+#include "GUID.h"
+#include "StringPool.h"
+#include "../Infrastructure/Jobs/JobSystem.h"
+#include "../Infrastructure/Logging/Logging.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+template<typename Type>
+uint64_t Mango::BinarySceneSerializer::WriteArray(const std::vector<Type>& values)
+{
+	static_assert(std::is_trivially_copyable_v<Type>, "Only trivially copyable values could be written to binary scene");
+	const size_t offset = AlignOffset(_data.size());
+	_data.resize(offset + values.size() * sizeof(Type));
+	if (!values.empty())
+	{
+		memcpy(_data.data() + offset, values.data(), values.size() * sizeof(Type));
+	}
+	return offset;
+}
+
+template<typename Type>
+void Mango::BinarySceneSerializer::WriteColumn(ColumnType type, const std::vector<uint32_t>& rows, const std::vector<Type>& values)
+{
+	Column column = {};
+	column.Type = type;
+	column.Count = static_cast<uint32_t>(values.size());
+	column.RowsOffset = rows.empty() ? 0 : WriteArray(rows);
+	column.ValuesOffset = WriteArray(values);
+	_columns.push_back(column);
+}
+
+template<typename Type>
+const Type* Mango::BinarySceneSerializer::GetArray(uint64_t offset, size_t count)
+{
+	// Arrays are aligned by writer, mapped file itself is page aligned
+	if (offset > _readSize || count > (_readSize - offset) / sizeof(Type) || offset % alignof(Type) != 0)
+	{
+		throw std::runtime_error("Scene file is truncated or corrupted");
+	}
+	return reinterpret_cast<const Type*>(_readData + offset);
+}
+
+std::vector<uint8_t> Mango::BinarySceneSerializer::Serialize(Mango::Scene& scene)
+{
+	auto& registry = scene._registry;
+	_data.clear();
+	_columns.clear();
+	_strings.clear();
+	_stringIndices.clear();
+	_data.resize(sizeof(Header));
+
+	// Streamed entities are saved in their chunk files, scene only keeps path to world manifest
+	std::vector<entt::entity> entities;
+	std::unordered_map<entt::entity, uint32_t> rows;
+	for (auto entity : registry.view<IdComponent, NameComponent, TransformComponent>(entt::exclude<ChunkComponent>))
+	{
+		rows[entity] = static_cast<uint32_t>(entities.size());
+		entities.push_back(entity);
+	}
+
+	// Dense columns
+	std::vector<uint64_t> ids;
+	std::vector<uint32_t> names;
+	std::vector<TransformRecord> transforms;
+	ids.reserve(entities.size());
+	names.reserve(entities.size());
+	transforms.reserve(entities.size());
+	for (auto entity : entities)
+	{
+		auto [id, name, transform] = registry.get<IdComponent, NameComponent, TransformComponent>(entity);
+		ids.push_back(static_cast<uint64_t>(id.GetId()));
+		names.push_back(AddString(name.GetName()));
+		transforms.push_back({ transform.GetTranslation(), transform.GetRotation(), transform.GetScale() });
+	}
+	const std::vector<uint32_t> implicitRows;
+	WriteColumn(ColumnType::Id, implicitRows, ids);
+	WriteColumn(ColumnType::Name, implicitRows, names);
+	WriteColumn(ColumnType::Transform, implicitRows, transforms);
+
+	// Sparse columns
+	std::vector<uint32_t> columnRows;
+	std::vector<glm::vec4> colors;
+	for (uint32_t row = 0; row < entities.size(); row++)
+	{
+		if (auto color = registry.try_get<ColorComponent>(entities[row]); color != nullptr)
+		{
+			columnRows.push_back(row);
+			colors.push_back(color->GetColor());
+		}
+	}
+	WriteColumn(ColumnType::Color, columnRows, colors);
+
+	columnRows.clear();
+	std::vector<uint32_t> geometries;
+	for (uint32_t row = 0; row < entities.size(); row++)
+	{
+		if (auto geometry = registry.try_get<GeometryComponent>(entities[row]); geometry != nullptr)
+		{
+			columnRows.push_back(row);
+			geometries.push_back(static_cast<uint32_t>(geometry->GetGeometry()));
+		}
+	}
+	WriteColumn(ColumnType::Geometry, columnRows, geometries);
+
+	columnRows.clear();
+	std::vector<CameraRecord> cameras;
+	for (uint32_t row = 0; row < entities.size(); row++)
+	{
+		if (auto camera = registry.try_get<CameraComponent>(entities[row]); camera != nullptr)
+		{
+			columnRows.push_back(row);
+			cameras.push_back({ camera->GetNearPlane(), camera->GetFarPlane(), camera->GetFOV(), camera->IsPrimary(), camera->IsEditorCamera() });
+		}
+	}
+	WriteColumn(ColumnType::Camera, columnRows, cameras);
+
+	columnRows.clear();
+	std::vector<uint32_t> rigidbodies;
+	for (uint32_t row = 0; row < entities.size(); row++)
+	{
+		if (auto rigidbody = registry.try_get<RigidbodyComponent>(entities[row]); rigidbody != nullptr)
+		{
+			columnRows.push_back(row);
+			rigidbodies.push_back(static_cast<uint32_t>(rigidbody->GetType()));
+		}
+	}
+	WriteColumn(ColumnType::Rigidbody, columnRows, rigidbodies);
+
+	columnRows.clear();
+	std::vector<uint32_t> scripts;
+	for (uint32_t row = 0; row < entities.size(); row++)
+	{
+		if (auto script = registry.try_get<ScriptComponent>(entities[row]); script != nullptr)
+		{
+			columnRows.push_back(row);
+			scripts.push_back(AddString(script->GetFileName()));
+		}
+	}
+	WriteColumn(ColumnType::Script, columnRows, scripts);
+
+	// Links to parents that aren't saved, e.g. streamed ones, are dropped
+	columnRows.clear();
+	std::vector<uint32_t> parents;
+	for (uint32_t row = 0; row < entities.size(); row++)
+	{
+		auto relationship = registry.try_get<RelationshipComponent>(entities[row]);
+		if (relationship == nullptr || relationship->GetParent() == entt::null)
+		{
+			continue;
+		}
+
+		auto parentRow = rows.find(relationship->GetParent());
+		if (parentRow != rows.end())
+		{
+			columnRows.push_back(row);
+			parents.push_back(parentRow->second);
+		}
+	}
+	WriteColumn(ColumnType::Relationship, columnRows, parents);
+
+	// Prefabs aren't entities, so their column has no rows
+	std::vector<PrefabRecord> prefabs;
+	for (const auto& [_, prefab] : scene.GetPrefabs())
+	{
+		PrefabRecord record = {};
+		record.Name = AddString(prefab.Name);
+		record.Translation = prefab.Translation;
+		record.Rotation = prefab.Rotation;
+		record.Scale = prefab.Scale;
+		record.ScriptFileName = NoString;
+		if (prefab.Color.has_value())
+		{
+			record.Components |= PrefabColor;
+			record.Color = prefab.Color.value();
+		}
+		if (prefab.Geometry.has_value())
+		{
+			record.Components |= PrefabGeometry;
+			record.Geometry = static_cast<uint32_t>(prefab.Geometry.value());
+		}
+		if (prefab.Rigidbody.has_value())
+		{
+			record.Components |= PrefabRigidbody;
+			record.BodyType = static_cast<uint32_t>(prefab.Rigidbody.value());
+		}
+		if (prefab.ScriptFileName.has_value())
+		{
+			record.Components |= PrefabScript;
+			record.ScriptFileName = AddString(prefab.ScriptFileName.value());
+		}
+		prefabs.push_back(record);
+	}
+	columnRows.clear();
+	WriteColumn(ColumnType::Prefab, columnRows, prefabs);
+
+	Header header = {};
+	header.Magic = Magic;
+	header.Version = Version;
+	header.EntitiesCount = static_cast<uint32_t>(entities.size());
+	header.WorldManifestPath = NoString;
+	std::string worldManifestPath;
+	if (scene._worldStreamer != nullptr)
+	{
+		worldManifestPath = scene._worldStreamer->GetManifestPath().string();
+		header.WorldManifestPath = AddString(worldManifestPath);
+	}
+
+	// String table
+	std::vector<uint32_t> stringOffsets;
+	std::vector<char> characters;
+	stringOffsets.reserve(_strings.size() + 1);
+	for (auto string : _strings)
+	{
+		stringOffsets.push_back(static_cast<uint32_t>(characters.size()));
+		characters.insert(characters.end(), string.begin(), string.end());
+	}
+	stringOffsets.push_back(static_cast<uint32_t>(characters.size()));
+	header.StringsCount = static_cast<uint32_t>(_strings.size());
+	// Characters follow offsets at the next aligned position
+	header.StringsOffset = WriteArray(stringOffsets);
+	WriteArray(characters);
+
+	header.ColumnsCount = static_cast<uint32_t>(_columns.size());
+	header.ColumnsOffset = WriteArray(_columns);
+	memcpy(_data.data(), &header, sizeof(Header));
+
+	_strings.clear();
+	_stringIndices.clear();
+	return std::move(_data);
+}
+
+void Mango::BinarySceneSerializer::Populate(Mango::Scene& scene, const uint8_t* data, size_t size, std::atomic<float>* progress, bool useJobs)
+{
+	_readData = data;
+	_readSize = size;
+	auto& registry = scene._registry;
+
+	Header header;
+	if (size < sizeof(Header))
+	{
+		throw std::runtime_error("Scene file is too small");
+	}
+	memcpy(&header, data, sizeof(Header));
+	if (header.Magic != Magic)
+	{
+		throw std::runtime_error("Not a binary scene file");
+	}
+	if (header.Version != Version)
+	{
+		throw std::runtime_error("Unsupported binary scene version " + std::to_string(header.Version));
+	}
+
+	const Column* columns = GetArray<Column>(header.ColumnsOffset, header.ColumnsCount);
+	const uint32_t* stringOffsets = GetArray<uint32_t>(header.StringsOffset, static_cast<size_t>(header.StringsCount) + 1);
+	const uint64_t charactersOffset = AlignOffset(header.StringsOffset + (static_cast<uint64_t>(header.StringsCount) + 1) * sizeof(uint32_t));
+	const char* characters = GetArray<char>(charactersOffset, stringOffsets[header.StringsCount]);
+
+	// Every distinct string is interned once, components only get handles
+	std::vector<Mango::StringHandle> strings(header.StringsCount);
+	for (uint32_t i = 0; i < header.StringsCount; i++)
+	{
+		if (stringOffsets[i] > stringOffsets[i + 1])
+		{
+			throw std::runtime_error("Scene file has corrupted string table");
+		}
+		strings[i] = Mango::StringPool::Intern(std::string_view(characters + stringOffsets[i], stringOffsets[i + 1] - stringOffsets[i]));
+	}
+	auto getString = [&strings](uint32_t index)
+	{
+		if (index >= strings.size())
+		{
+			throw std::runtime_error("Scene file references missing string");
+		}
+		return strings[index];
+	};
+
+	// Every entity has id, name and transform. Every known column is stored once,
+	// otherwise components of its entities would be inserted twice
+	uint32_t seenColumns = 0;
+	for (uint32_t i = 0; i < header.ColumnsCount; i++)
+	{
+		const auto type = static_cast<uint32_t>(columns[i].Type);
+		if (type > static_cast<uint32_t>(ColumnType::Prefab))
+		{
+			continue;
+		}
+		if (seenColumns & (1u << type))
+		{
+			throw std::runtime_error("Scene file has repeated component column");
+		}
+		seenColumns |= 1u << type;
+
+		const bool isDense = columns[i].Type == ColumnType::Id || columns[i].Type == ColumnType::Name || columns[i].Type == ColumnType::Transform;
+		if (isDense && columns[i].Count != header.EntitiesCount)
+		{
+			throw std::runtime_error("Scene file has incomplete component column");
+		}
+	}
+	const uint32_t denseColumns = (1u << static_cast<uint32_t>(ColumnType::Id)) | (1u << static_cast<uint32_t>(ColumnType::Name)) | (1u << static_cast<uint32_t>(ColumnType::Transform));
+	if ((seenColumns & denseColumns) != denseColumns)
+	{
+		throw std::runtime_error("Scene file has no id, name or transform column");
+	}
+
+	std::vector<entt::entity> entities(header.EntitiesCount);
+	registry.create(entities.begin(), entities.end());
+	if (progress != nullptr)
+	{
+		progress->store(0.1f, std::memory_order_relaxed);
+	}
+
+	// Entities of sparse column, rows are checked before they are used.
+	// Row stamps tell which column row was last seen in, so row repeated within a column is found without clearing
+	std::vector<entt::entity> columnEntities;
+	std::vector<uint32_t> rowStamps(entities.size(), 0);
+	auto getColumnEntities = [this, &entities, &columnEntities, &rowStamps](const Column& column, uint32_t columnIndex)
+	{
+		const uint32_t* rows = GetArray<uint32_t>(column.RowsOffset, column.Count);
+		columnEntities.resize(column.Count);
+		for (uint32_t i = 0; i < column.Count; i++)
+		{
+			if (rows[i] >= entities.size())
+			{
+				throw std::runtime_error("Scene file references missing entity");
+			}
+			if (rowStamps[rows[i]] == columnIndex + 1)
+			{
+				throw std::runtime_error("Scene file has repeated entity in component column");
+			}
+			rowStamps[rows[i]] = columnIndex + 1;
+			columnEntities[i] = entities[rows[i]];
+		}
+		return rows;
+	};
+
+	// Bodies and parents need ids and transforms of their entities, so their columns are read after all others
+	std::vector<uint32_t> deferredColumns;
+	for (uint32_t columnIndex = 0; columnIndex < header.ColumnsCount; columnIndex++)
+	{
+		const auto& column = columns[columnIndex];
+		if (column.Type == ColumnType::Rigidbody || column.Type == ColumnType::Relationship)
+		{
+			deferredColumns.push_back(columnIndex);
+			continue;
+		}
+
+		switch (column.Type)
+		{
+		case ColumnType::Id:
+		{
+			const uint64_t* values = GetArray<uint64_t>(column.ValuesOffset, column.Count);
+			std::vector<IdComponent> ids;
+			ids.reserve(column.Count);
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				ids.emplace_back(Mango::GUID(values[i]));
+			}
+			registry.insert<IdComponent>(entities.begin(), entities.end(), ids.begin());
+			break;
+		}
+		case ColumnType::Name:
+		{
+			const uint32_t* values = GetArray<uint32_t>(column.ValuesOffset, column.Count);
+			std::vector<NameComponent> names;
+			names.reserve(column.Count);
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				names.emplace_back(getString(values[i]));
+			}
+			registry.insert<NameComponent>(entities.begin(), entities.end(), names.begin());
+			break;
+		}
+		case ColumnType::Transform:
+		{
+			const TransformRecord* values = GetArray<TransformRecord>(column.ValuesOffset, column.Count);
+			// Transforms are decoded on all job system threads, registry is only touched on this thread
+			std::vector<TransformComponent> transforms(column.Count);
+			auto decodeTransforms = [values, &transforms](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					transforms[i] = TransformComponent(values[i].Translation, values[i].Rotation, values[i].Scale);
+				}
+			};
+			if (useJobs)
+			{
+				Mango::JobSystem::ParallelFor(column.Count, DecodeGrainSize, decodeTransforms);
+			}
+			else
+			{
+				decodeTransforms(0, column.Count);
+			}
+			registry.insert<TransformComponent>(entities.begin(), entities.end(), transforms.begin());
+			break;
+		}
+		case ColumnType::Color:
+		{
+			getColumnEntities(column, columnIndex);
+			const glm::vec4* values = GetArray<glm::vec4>(column.ValuesOffset, column.Count);
+			std::vector<ColorComponent> colors(values, values + column.Count);
+			registry.insert<ColorComponent>(columnEntities.begin(), columnEntities.end(), colors.begin());
+			break;
+		}
+		case ColumnType::Geometry:
+		{
+			getColumnEntities(column, columnIndex);
+			const uint32_t* values = GetArray<uint32_t>(column.ValuesOffset, column.Count);
+			std::vector<GeometryComponent> geometries;
+			geometries.reserve(column.Count);
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				geometries.emplace_back(GetGeometryType(values[i]));
+			}
+			registry.insert<GeometryComponent>(columnEntities.begin(), columnEntities.end(), geometries.begin());
+			break;
+		}
+		case ColumnType::Camera:
+		{
+			getColumnEntities(column, columnIndex);
+			const CameraRecord* values = GetArray<CameraRecord>(column.ValuesOffset, column.Count);
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				auto& camera = registry.emplace<CameraComponent>(columnEntities[i], values[i].IsEditorCamera != 0);
+				camera.SetClippingPlanes(values[i].NearPlane, values[i].FarPlane);
+				camera.SetFOV(values[i].FovDegrees);
+				camera.SetPrimary(values[i].IsPrimary != 0);
+			}
+			break;
+		}
+		case ColumnType::Script:
+		{
+			getColumnEntities(column, columnIndex);
+			const uint32_t* values = GetArray<uint32_t>(column.ValuesOffset, column.Count);
+			std::vector<ScriptComponent> scripts(column.Count);
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				scripts[i].SetFileName(Mango::StringPool::Get(getString(values[i])));
+			}
+			registry.insert<ScriptComponent>(columnEntities.begin(), columnEntities.end(), scripts.begin());
+			break;
+		}
+		case ColumnType::Prefab:
+		{
+			const PrefabRecord* values = GetArray<PrefabRecord>(column.ValuesOffset, column.Count);
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				const auto& record = values[i];
+				Mango::Prefab prefab;
+				prefab.Name = Mango::StringPool::Get(getString(record.Name));
+				prefab.Translation = record.Translation;
+				prefab.Rotation = record.Rotation;
+				prefab.Scale = record.Scale;
+				if (record.Components & PrefabColor)
+				{
+					prefab.Color = record.Color;
+				}
+				if (record.Components & PrefabGeometry)
+				{
+					prefab.Geometry = GetGeometryType(record.Geometry);
+				}
+				if (record.Components & PrefabRigidbody)
+				{
+					prefab.Rigidbody = GetRigidbodyType(record.BodyType);
+				}
+				if (record.Components & PrefabScript)
+				{
+					prefab.ScriptFileName = Mango::StringPool::Get(getString(record.ScriptFileName));
+				}
+				scene.RegisterPrefab(prefab);
+			}
+			break;
+		}
+		default:
+			// Columns written by newer versions of the same format are skipped
+			break;
+		}
+
+		if (progress != nullptr)
+		{
+			progress->store(0.1f + 0.9f * (columnIndex + 1) / header.ColumnsCount, std::memory_order_relaxed);
+		}
+	}
+
+	for (auto columnIndex : deferredColumns)
+	{
+		const auto& column = columns[columnIndex];
+		switch (column.Type)
+		{
+		case ColumnType::Rigidbody:
+		{
+			// Every rigidbody owns its own Box2D body, so they can't be inserted in bulk
+			getColumnEntities(column, columnIndex);
+			const uint32_t* values = GetArray<uint32_t>(column.ValuesOffset, column.Count);
+			// Check every body type first, so a bad value doesn't leave bodies half created
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				GetRigidbodyType(values[i]);
+			}
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				const auto& id = registry.get<IdComponent>(columnEntities[i]).GetId();
+				b2BodyDef bodyDefinition;
+				bodyDefinition.userData.pointer = static_cast<uintptr_t>(static_cast<uint64_t>(id));
+				b2Body* body = scene._physicsWorld.CreateBody(&bodyDefinition);
+				auto& rigidbody = registry.emplace<RigidbodyComponent>(columnEntities[i], body);
+				rigidbody.SetType(GetRigidbodyType(values[i]));
+			}
+			break;
+		}
+		case ColumnType::Relationship:
+		{
+			const uint32_t* rows = getColumnEntities(column, columnIndex);
+			const uint32_t* values = GetArray<uint32_t>(column.ValuesOffset, column.Count);
+			for (uint32_t i = 0; i < column.Count; i++)
+			{
+				if (values[i] >= entities.size() || !scene.SetEntityParent(columnEntities[i], entities[values[i]]))
+				{
+					M_WARN("Unable to restore parent of entity in row " << rows[i]);
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	// Streamed world is optional, its chunks are loaded once scene is updated
+	if (header.WorldManifestPath != NoString)
+	{
+		scene.OpenWorld(Mango::StringPool::Get(getString(header.WorldManifestPath)));
+	}
+
+	_readData = nullptr;
+	_readSize = 0;
+}
+
+Mango::GeometryType Mango::BinarySceneSerializer::GetGeometryType(uint32_t value)
+{
+	if (value > static_cast<uint32_t>(Mango::GeometryType::Rectangle))
+	{
+		throw std::runtime_error("Scene file has unknown geometry " + std::to_string(value));
+	}
+	return static_cast<Mango::GeometryType>(value);
+}
+
+Mango::RigidbodyType Mango::BinarySceneSerializer::GetRigidbodyType(uint32_t value)
+{
+	if (value > static_cast<uint32_t>(Mango::RigidbodyType::Kinematic))
+	{
+		throw std::runtime_error("Scene file has unknown body type " + std::to_string(value));
+	}
+	return static_cast<Mango::RigidbodyType>(value);
+}
+
+uint64_t Mango::BinarySceneSerializer::AlignOffset(uint64_t offset)
+{
+	return (offset + ColumnAlignment - 1) / ColumnAlignment * ColumnAlignment;
+}
+
+uint32_t Mango::BinarySceneSerializer::AddString(std::string_view string)
+{
+	auto [it, inserted] = _stringIndices.emplace(string, static_cast<uint32_t>(_strings.size()));
+	if (inserted)
+	{
+		_strings.push_back(string);
+	}
+	return it->second;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Scene.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Mango
+{
+	// Versioned binary scene format (.mscene). Every component type is stored as a contiguous column,
+	// so columns are inserted into registry in bulk straight from memory mapped file.
+	// Entities are referenced by their row in file, strings by their index in string table
+	class BinarySceneSerializer
+	{
+	public:
+		// "MSCN"
+		static constexpr uint32_t Magic = 0x4E43534D;
+		static constexpr uint32_t Version = 1;
+
+		std::vector<uint8_t> Serialize(Mango::Scene& scene);
+		// Throws if data isn't a scene of supported version. Data is only read while scene is populated.
+		// Without jobs every column is decoded on calling thread
+		void Populate(Mango::Scene& scene, const uint8_t* data, size_t size, std::atomic<float>* progress = nullptr, bool useJobs = true);
+
+	private:
+		enum class ColumnType : uint32_t
+		{
+			Id = 0,
+			Name = 1,
+			Transform = 2,
+			Color = 3,
+			Geometry = 4,
+			Camera = 5,
+			Rigidbody = 6,
+			Script = 7,
+			Relationship = 8,
+			Prefab = 9
+		};
+
+		static constexpr uint32_t NoString = UINT32_MAX;
+		static constexpr size_t ColumnAlignment = 16;
+		// Values of column decoded by one job
+		static constexpr size_t DecodeGrainSize = 16384;
+
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t EntitiesCount;
+			uint32_t ColumnsCount;
+			uint64_t ColumnsOffset;
+			// String table is StringsCount + 1 offsets followed by characters of all strings
+			uint64_t StringsOffset;
+			uint32_t StringsCount;
+			uint32_t WorldManifestPath;
+		};
+
+		// Id, name and transform columns have value for every entity, so their rows are implicit.
+		// Other columns store entity row of every value
+		struct Column
+		{
+			ColumnType Type;
+			uint32_t Count;
+			uint64_t RowsOffset;
+			uint64_t ValuesOffset;
+		};
+
+		struct TransformRecord
+		{
+			glm::vec3 Translation;
+			// Rotation in degrees
+			glm::vec3 Rotation;
+			glm::vec3 Scale;
+		};
+
+		struct CameraRecord
+		{
+			float NearPlane;
+			float FarPlane;
+			float FovDegrees;
+			uint32_t IsPrimary;
+			uint32_t IsEditorCamera;
+		};
+
+		// Flags of optional components prefab defines
+		enum PrefabComponents : uint32_t
+		{
+			PrefabColor = 1 << 0,
+			PrefabGeometry = 1 << 1,
+			PrefabRigidbody = 1 << 2,
+			PrefabScript = 1 << 3
+		};
+
+		struct PrefabRecord
+		{
+			uint32_t Name;
+			uint32_t Components;
+			glm::vec3 Translation;
+			glm::vec3 Rotation;
+			glm::vec3 Scale;
+			glm::vec4 Color;
+			uint32_t Geometry;
+			// Static and dynamic values are the former "is dynamic" flag, so older files read as is
+			uint32_t BodyType;
+			uint32_t ScriptFileName;
+		};
+
+	private:
+		// Writing
+		std::vector<uint8_t> _data;
+		std::vector<Column> _columns;
+		std::vector<std::string_view> _strings;
+		std::unordered_map<std::string_view, uint32_t> _stringIndices;
+
+		// Reading
+		const uint8_t* _readData = nullptr;
+		size_t _readSize = 0;
+
+	private:
+		uint32_t AddString(std::string_view string);
+		static uint64_t AlignOffset(uint64_t offset);
+		// Throws if value isn't one of geometry types
+		static Mango::GeometryType GetGeometryType(uint32_t value);
+		static Mango::RigidbodyType GetRigidbodyType(uint32_t value);
+		// Appends array aligned to column alignment, returns its offset
+		template<typename Type>
+		uint64_t WriteArray(const std::vector<Type>& values);
+		template<typename Type>
+		void WriteColumn(ColumnType type, const std::vector<uint32_t>& rows, const std::vector<Type>& values);
+
+		// Returns pointer into read data, throws if array doesn't fit into it
+		template<typename Type>
+		const Type* GetArray(uint64_t offset, size_t count);
+	};
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "GUID.h"
+
+namespace Mango
+{
+	// Contact of two bodies that began or ended during physics step
+	struct CollisionEvent
+	{
+		bool IsBegin;
+		Mango::GUID FirstId;
+		Mango::GUID SecondId;
+	};
+}
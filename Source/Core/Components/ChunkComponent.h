@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Mango
+{
+	// Marks entity streamed into scene as a part of world chunk, entity is removed when its chunk is unloaded
+	class ChunkComponent
+	{
+	public:
+		ChunkComponent() = default;
+		ChunkComponent(uint32_t chunkIndex) { _chunkIndex = chunkIndex; }
+
+		inline uint32_t GetChunkIndex() const { return _chunkIndex; }
+
+	private:
+		uint32_t _chunkIndex = 0;
+	};
+}
@@ -3,17 +3,24 @@
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 namespace Mango
 {
 	class ColorComponent
 	{
 	public:
+		ColorComponent() : ColorComponent(glm::vec4(1.0f)) {}
 		ColorComponent(glm::vec4 color) { _color = color; }
 
 		inline glm::vec4 GetColor() const { return _color; }
-		void SetColor(glm::vec4 color) { _color = color; }
+		void SetColor(glm::vec4 color) { _version += color != _color; _color = color; }
+
+		// Incremented on every color change, renderer resends instances with changed version
+		inline uint32_t GetVersion() const { return _version; }
 
 	private:
 		glm::vec4 _color;
+		uint32_t _version = 0;
 	};
 }
@@ -8,3 +8,5 @@
 #include "CameraComponent.h"
 #include "RigidbodyComponent.h"
 #include "ScriptComponent.h"
+#include "RelationshipComponent.h"
+#include "ChunkComponent.h"
@@ -7,8 +7,9 @@ namespace Mango
 	class GeometryComponent
 	{
 	public:
+		GeometryComponent() : GeometryComponent(Mango::GeometryType::Triangle) {}
 		GeometryComponent(Mango::GeometryType geometry) { _geometry = geometry; }
-		inline Mango::GeometryType GetGeometry() { return _geometry; }
+		inline Mango::GeometryType GetGeometry() const { return _geometry; }
 		
 	private:
 		Mango::GeometryType _geometry;
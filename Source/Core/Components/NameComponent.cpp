@@ -1,40 +1,67 @@
-#define _CRT_SECURE_NO_WARNINGS
 #include "NameComponent.h"
 
-#include "../../Infrastructure/Assert/Assert.h"
+#include <charconv>
+#include <cstring>
 
-#include <utility>
+namespace
+{
+	constexpr std::string_view DefaultNamePrefix = "Entity ";
+	constexpr uint64_t DefaultNameKeyBit = 1ull << 63;
+}
 
-uint64_t Mango::NameComponent::_count = 0;
+std::atomic<uint64_t> Mango::NameComponent::_count = 0;
 
 Mango::NameComponent::NameComponent()
 {
-	SetName("Entity " + std::to_string(_count));
-	_count++;
+	std::memcpy(_defaultName, DefaultNamePrefix.data(), DefaultNamePrefix.size());
+	auto result = std::to_chars(_defaultName + DefaultNamePrefix.size(), _defaultName + sizeof(_defaultName) - 1, _count.fetch_add(1, std::memory_order_relaxed));
+	*result.ptr = '\0';
 }
 
-Mango::NameComponent::NameComponent(std::string name)
+Mango::NameComponent::NameComponent(std::string_view name)
 {
 	SetName(name);
 }
 
-Mango::NameComponent::~NameComponent()
+void Mango::NameComponent::SetName(std::string_view name)
 {
-	free(_buffer);
+	_handle = Mango::StringPool::Intern(name);
+	_defaultName[0] = '\0';
 }
 
-void Mango::NameComponent::SetName(std::string name)
+uint64_t Mango::NameComponent::GetNameKey() const
 {
-	void* rawBuffer = malloc(_bufferSize);
-	if (rawBuffer == nullptr)
+	if (!IsDefaultName())
 	{
-		free(rawBuffer);
-		M_ASSERT(false && "Unable to allocate memory for NameComponent buffer");
+		return _handle;
 	}
 
-	_buffer = (char*)rawBuffer;
-	memset(_buffer, 0, 128);
+	uint64_t key = 0;
+	FindDefaultNameKey(_defaultName, &key);
+	return key;
+}
+
+bool Mango::NameComponent::FindDefaultNameKey(std::string_view name, uint64_t* key)
+{
+	if (!name.starts_with(DefaultNamePrefix))
+	{
+		return false;
+	}
+
+	// Generated numbers never have leading zeros, so "Entity 05" is a regular name
+	const auto digits = name.substr(DefaultNamePrefix.size());
+	if (digits.empty() || (digits.size() > 1 && digits[0] == '0'))
+	{
+		return false;
+	}
+
+	uint64_t number = 0;
+	auto result = std::from_chars(digits.data(), digits.data() + digits.size(), number);
+	if (result.ec != std::errc() || result.ptr != digits.data() + digits.size() || (number & DefaultNameKeyBit) != 0)
+	{
+		return false;
+	}
 
-	auto copyCharsCount = std::min(name.size() + 1, static_cast<size_t>(127));
-	strncat(_buffer, name.c_str(), copyCharsCount);
+	*key = number | DefaultNameKeyBit;
+	return true;
 }
@@ -1,25 +1,42 @@
 #pragma once
 
+#include "../StringPool.h"
+
+#include <atomic>
 #include <cstdint>
-#include <string>
+#include <string_view>
 
 namespace Mango
 {
+	// Name is stored in StringPool, component only keeps its handle.
+	// Default "Entity N" names are unique, so they are kept by component itself instead of growing the pool with every spawned entity.
+	// NOTE: Scene keeps an index of entity names. Rename entities that are already in the registry
+	// through Scene::SetEntityName or registry patch, so the index is notified about the change
 	class NameComponent
 	{
 	public:
 		NameComponent();
-		NameComponent(std::string name);
-		~NameComponent();
+		NameComponent(std::string_view name);
+		// Name that is already interned, e.g. by scene loader that interns every distinct name once
+		explicit NameComponent(Mango::StringHandle handle) { _handle = handle; }
+
+		// View of default name points into component, it's valid until component is moved or renamed
+		inline std::string_view GetName() const { return IsDefaultName() ? std::string_view(_defaultName) : Mango::StringPool::Get(_handle); }
+		// Default names aren't interned, their handle is empty
+		inline Mango::StringHandle GetNameHandle() const { return _handle; }
+		inline bool IsDefaultName() const { return _defaultName[0] != '\0'; }
+		void SetName(std::string_view name);
 
-		inline char* GetName() { return _buffer; }
-		inline char* GetName() const { return _buffer; }
-		void SetName(std::string name);
-		uint32_t GetBufferSize() { return _bufferSize; }
+		// Key of name in scene index. Interned names are keyed by their handle, default names by their number with the top bit set
+		uint64_t GetNameKey() const;
+		// Key that default name would have, returns false if name isn't a default one
+		static bool FindDefaultNameKey(std::string_view name, uint64_t* key);
 
 	private:
-		static uint64_t _count;
-		const uint32_t _bufferSize = 128;
-		char* _buffer;
+		// Scenes could be built on background threads
+		static std::atomic<uint64_t> _count;
+		Mango::StringHandle _handle = Mango::StringPool::EmptyHandle;
+		// "Entity " prefix, up to 20 digits and null terminator
+		char _defaultName[28] = {};
 	};
 }
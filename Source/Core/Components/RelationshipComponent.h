@@ -0,0 +1,44 @@
+#pragma once
+
+#include <entt/entity/entity.hpp>
+
+#include <cstdint>
+
+namespace Mango
+{
+	// Parent/child links between entities. Children of a parent form a doubly linked list,
+	// so hierarchy could be changed without any allocations. Use Scene::SetEntityParent to change the hierarchy.
+	class RelationshipComponent
+	{
+	public:
+		RelationshipComponent() = default;
+
+		inline entt::entity GetParent() const { return _parent; }
+		inline entt::entity GetFirstChild() const { return _firstChild; }
+		inline entt::entity GetPreviousSibling() const { return _previousSibling; }
+		inline entt::entity GetNextSibling() const { return _nextSibling; }
+		inline uint32_t GetChildrenCount() const { return _childrenCount; }
+		// Number of ancestors, root entities have depth 0
+		inline uint32_t GetDepth() const { return _depth; }
+
+		void SetParent(entt::entity parent) { _parent = parent; }
+		void SetFirstChild(entt::entity child) { _firstChild = child; }
+		void SetPreviousSibling(entt::entity sibling) { _previousSibling = sibling; }
+		void SetNextSibling(entt::entity sibling) { _nextSibling = sibling; }
+		void SetChildrenCount(uint32_t count) { _childrenCount = count; }
+		void SetDepth(uint32_t depth) { _depth = depth; }
+
+		// Scene uses this to visit every node only once per transform propagation
+		inline uint32_t GetPropagationStamp() const { return _propagationStamp; }
+		void SetPropagationStamp(uint32_t stamp) { _propagationStamp = stamp; }
+
+	private:
+		entt::entity _parent = entt::null;
+		entt::entity _firstChild = entt::null;
+		entt::entity _previousSibling = entt::null;
+		entt::entity _nextSibling = entt::null;
+		uint32_t _childrenCount = 0;
+		uint32_t _depth = 0;
+		uint32_t _propagationStamp = 0;
+	};
+}
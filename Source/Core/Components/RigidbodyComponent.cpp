@@ -1,38 +1,110 @@
 #include "RigidbodyComponent.h"
 
-Mango::RigidbodyComponent::RigidbodyComponent(b2Body* body) : _body(body)
+#include "../../Infrastructure/Assert/Assert.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+
+Mango::RigidbodyComponent::RigidbodyComponent(b2Body* body)
+{
+	AttachBody(body);
+}
+
+void Mango::RigidbodyComponent::SetSimulatedPose(glm::vec2 position, float angleRadians)
+{
+	_previousPosition = _position;
+	_previousAngle = _angle;
+	_position = position;
+	_angle = angleRadians;
+}
+
+void Mango::RigidbodyComponent::SetPose(glm::vec2 position, float angleRadians)
+{
+	_position = position;
+	_angle = angleRadians;
+	_previousPosition = position;
+	_previousAngle = angleRadians;
+}
+
+void Mango::RigidbodyComponent::AttachBody(b2Body* body)
 {
-	_body->SetType(b2_dynamicBody);
+	_body = body;
+	_body->SetType(ToBodyType(_type));
+	const b2Vec2& position = _body->GetPosition();
+	SetPose(glm::vec2(position.x, position.y), _body->GetAngle());
+
+	// Movement requested before body existed
+	if (_hasPendingVelocity)
+	{
+		_body->SetLinearVelocity({ _pendingVelocity.x, _pendingVelocity.y });
+		_hasPendingVelocity = false;
+	}
+	if (_pendingForce != glm::vec2(0.0f))
+	{
+		_body->ApplyForceToCenter({ _pendingForce.x, _pendingForce.y }, true);
+		_pendingForce = glm::vec2(0.0f);
+	}
 }
 
-void Mango::RigidbodyComponent::SetDynamic(bool isDynamic)
+void Mango::RigidbodyComponent::SetType(Mango::RigidbodyType type)
 {
-	_isDynamic = isDynamic;
-	_body->SetType(_isDynamic ? b2_dynamicBody : b2_staticBody);
+	_type = type;
+	// Pending movement is only meant for the previous kinematic type
+	_hasTarget = false;
+	_isDriven = false;
+	if (_body != nullptr)
+	{
+		_body->SetType(ToBodyType(_type));
+	}
 }
 
 void Mango::RigidbodyComponent::SetTransform(glm::vec2 position, float angleRadians)
 {
+	if (_body == nullptr)
+	{
+		SetPose(position, angleRadians);
+		return;
+	}
+
 	_body->SetTransform({ position.x, position.y }, angleRadians);
+	// Teleported body must not be interpolated from its old pose
+	SetPose(position, angleRadians);
 }
 
-void Mango::RigidbodyComponent::SetFixture(b2FixtureDef fixture)
+void Mango::RigidbodyComponent::SetShape(const b2Shape& shape)
 {
-	_fixture = _body->CreateFixture(&fixture);
+	// Fixture is built by scene once body is created
+	if (_body == nullptr)
+	{
+		return;
+	}
+
+	DestroyFixture();
+
+	b2FixtureDef fixtureDefinition;
+	fixtureDefinition.shape = &shape;
+	fixtureDefinition.density = _density;
+	fixtureDefinition.friction = _friction;
+	_fixture = _body->CreateFixture(&fixtureDefinition);
 }
 
 void Mango::RigidbodyComponent::SetDensity(float density)
 {
+	_density = density;
 	if (_fixture == nullptr)
 	{
 		return;
 	}
 
 	_fixture->SetDensity(density);
+	// Fixture density only affects body mass once mass is recomputed
+	_body->ResetMassData();
 }
 
 void Mango::RigidbodyComponent::SetFriction(float friction)
 {
+	_friction = friction;
 	if (_fixture == nullptr)
 	{
 		return;
@@ -43,10 +115,200 @@ void Mango::RigidbodyComponent::SetFriction(float friction)
 
 void Mango::RigidbodyComponent::DestroyFixture()
 {
+	if (_fixture == nullptr)
+	{
+		return;
+	}
+
 	_body->DestroyFixture(_fixture);
+	_fixture = nullptr;
 }
 
 void Mango::RigidbodyComponent::ApplyForce(glm::vec2 force)
 {
+	if (_body == nullptr)
+	{
+		_pendingForce += force;
+		return;
+	}
+
 	_body->ApplyForceToCenter({ force.x, force.y }, true);
 }
+
+void Mango::RigidbodyComponent::SetVelocity(glm::vec2 velocity)
+{
+	_isDriven = false;
+	if (_body == nullptr)
+	{
+		_pendingVelocity = velocity;
+		_hasPendingVelocity = true;
+		return;
+	}
+
+	_body->SetLinearVelocity({ velocity.x, velocity.y });
+}
+
+void Mango::RigidbodyComponent::SetTargetPosition(glm::vec2 position)
+{
+	if (!_hasTarget)
+	{
+		_targetAngle = _angle;
+		_hasTarget = true;
+	}
+	_targetPosition = position;
+}
+
+void Mango::RigidbodyComponent::SetTargetAngle(float angleRadians)
+{
+	if (!_hasTarget)
+	{
+		_targetPosition = _position;
+		_hasTarget = true;
+	}
+	_targetAngle = angleRadians;
+}
+
+void Mango::RigidbodyComponent::DriveToTarget(float timeStep)
+{
+	// Target is kept until body is created
+	if (_body == nullptr)
+	{
+		return;
+	}
+
+	const b2Vec2& position = _body->GetPosition();
+	const glm::vec2 velocity = (_targetPosition - glm::vec2(position.x, position.y)) / timeStep;
+	// Body turns the shortest way, angles of target and body could differ by full turns
+	const float angleDelta = std::remainder(_targetAngle - _body->GetAngle(), glm::two_pi<float>());
+	_body->SetLinearVelocity({ velocity.x, velocity.y });
+	_body->SetAngularVelocity(angleDelta / timeStep);
+	_hasTarget = false;
+	_isDriven = true;
+}
+
+void Mango::RigidbodyComponent::StopDriving()
+{
+	if (!_isDriven || _hasTarget || _body == nullptr)
+	{
+		return;
+	}
+
+	_body->SetLinearVelocity({ 0.0f, 0.0f });
+	_body->SetAngularVelocity(0.0f);
+	_isDriven = false;
+}
+
+Mango::RigidbodyState Mango::RigidbodyComponent::GetState() const
+{
+	M_ASSERT(_body != nullptr && "Snapshot of rigidbody requires its body to be created");
+	Mango::RigidbodyState state{};
+	state.UserData = _body->GetUserData().pointer;
+	state.Type = _body->GetType();
+	state.Position = _body->GetPosition();
+	state.Angle = _body->GetAngle();
+	state.LinearVelocity = _body->GetLinearVelocity();
+	state.AngularVelocity = _body->GetAngularVelocity();
+	state.LinearDamping = _body->GetLinearDamping();
+	state.AngularDamping = _body->GetAngularDamping();
+	state.GravityScale = _body->GetGravityScale();
+	state.Awake = _body->IsAwake();
+	state.Enabled = _body->IsEnabled();
+	state.FixedRotation = _body->IsFixedRotation();
+	state.Bullet = _body->IsBullet();
+	state.SleepingAllowed = _body->IsSleepingAllowed();
+
+	// Bodies only get polygon fixtures
+	state.HasFixture = _fixture != nullptr && _fixture->GetType() == b2Shape::e_polygon;
+	if (state.HasFixture)
+	{
+		const auto* shape = static_cast<const b2PolygonShape*>(_fixture->GetShape());
+		state.VertexCount = shape->m_count;
+		state.Centroid = shape->m_centroid;
+		for (int32_t i = 0; i < shape->m_count; i++)
+		{
+			state.Vertices[i] = shape->m_vertices[i];
+			state.Normals[i] = shape->m_normals[i];
+		}
+		state.Radius = shape->m_radius;
+		state.Restitution = _fixture->GetRestitution();
+		state.RestitutionThreshold = _fixture->GetRestitutionThreshold();
+		state.IsSensor = _fixture->IsSensor();
+		state.Filter = _fixture->GetFilterData();
+	}
+
+	state.Density = _density;
+	state.Friction = _friction;
+	state.BodyType = _type;
+	state.IsDriven = _isDriven;
+	state.PreviousPosition = _previousPosition;
+	state.PreviousAngle = _previousAngle;
+	return state;
+}
+
+void Mango::RigidbodyComponent::RestoreState(b2World& world, const Mango::RigidbodyState& state)
+{
+	b2BodyDef bodyDefinition;
+	bodyDefinition.userData.pointer = state.UserData;
+	bodyDefinition.type = state.Type;
+	bodyDefinition.position = state.Position;
+	bodyDefinition.angle = state.Angle;
+	bodyDefinition.linearVelocity = state.LinearVelocity;
+	bodyDefinition.angularVelocity = state.AngularVelocity;
+	bodyDefinition.linearDamping = state.LinearDamping;
+	bodyDefinition.angularDamping = state.AngularDamping;
+	bodyDefinition.gravityScale = state.GravityScale;
+	bodyDefinition.awake = state.Awake;
+	bodyDefinition.enabled = state.Enabled;
+	bodyDefinition.fixedRotation = state.FixedRotation;
+	bodyDefinition.bullet = state.Bullet;
+	bodyDefinition.allowSleep = state.SleepingAllowed;
+	_body = world.CreateBody(&bodyDefinition);
+	_fixture = nullptr;
+
+	if (state.HasFixture)
+	{
+		// Shape is copied as is, so restored hull is exactly the captured one
+		b2PolygonShape shape;
+		shape.m_count = state.VertexCount;
+		shape.m_centroid = state.Centroid;
+		for (int32_t i = 0; i < state.VertexCount; i++)
+		{
+			shape.m_vertices[i] = state.Vertices[i];
+			shape.m_normals[i] = state.Normals[i];
+		}
+		shape.m_radius = state.Radius;
+
+		b2FixtureDef fixtureDefinition;
+		fixtureDefinition.shape = &shape;
+		fixtureDefinition.density = state.Density;
+		fixtureDefinition.friction = state.Friction;
+		fixtureDefinition.restitution = state.Restitution;
+		fixtureDefinition.restitutionThreshold = state.RestitutionThreshold;
+		fixtureDefinition.isSensor = state.IsSensor;
+		fixtureDefinition.filter = state.Filter;
+		_fixture = _body->CreateFixture(&fixtureDefinition);
+	}
+
+	_type = state.BodyType;
+	_hasTarget = false;
+	_isDriven = state.IsDriven;
+	_density = state.Density;
+	_friction = state.Friction;
+	_position = glm::vec2(state.Position.x, state.Position.y);
+	_angle = state.Angle;
+	_previousPosition = state.PreviousPosition;
+	_previousAngle = state.PreviousAngle;
+}
+
+b2BodyType Mango::RigidbodyComponent::ToBodyType(Mango::RigidbodyType type)
+{
+	switch (type)
+	{
+	case Mango::RigidbodyType::Static:
+		return b2_staticBody;
+	case Mango::RigidbodyType::Kinematic:
+		return b2_kinematicBody;
+	default:
+		return b2_dynamicBody;
+	}
+}
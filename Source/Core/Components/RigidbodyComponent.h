@@ -1,35 +1,130 @@
 #pragma once
 
+#include "../RigidbodyType.h"
+
 #include <glm/glm.hpp>
 #include <box2d/box2d.h>
 
+#include <cstdint>
 #include <memory>
 
 namespace Mango
 {
+	// Everything needed to recreate physics body with its fixture exactly as it was
+	struct RigidbodyState
+	{
+		uintptr_t UserData;
+		b2BodyType Type;
+		b2Vec2 Position;
+		float Angle;
+		b2Vec2 LinearVelocity;
+		float AngularVelocity;
+		float LinearDamping;
+		float AngularDamping;
+		float GravityScale;
+		bool Awake;
+		bool Enabled;
+		bool FixedRotation;
+		bool Bullet;
+		bool SleepingAllowed;
+
+		bool HasFixture;
+		int32_t VertexCount;
+		b2Vec2 Centroid;
+		b2Vec2 Vertices[b2_maxPolygonVertices];
+		b2Vec2 Normals[b2_maxPolygonVertices];
+		float Radius;
+		float Density;
+		float Friction;
+		float Restitution;
+		float RestitutionThreshold;
+		bool IsSensor;
+		b2Filter Filter;
+
+		Mango::RigidbodyType BodyType;
+		bool IsDriven;
+		glm::vec2 PreviousPosition;
+		float PreviousAngle;
+	};
+
 	class RigidbodyComponent
 	{
 	public:
+		RigidbodyComponent() = default;
 		RigidbodyComponent(b2Body* body);
 
-		inline bool IsDynamic() { return _isDynamic; }
-		inline glm::vec2 GetPosition() { b2Vec2 position = _body->GetPosition(); return glm::vec2(position.x, position.y); }
+		inline Mango::RigidbodyType GetType() const { return _type; }
+		inline float GetDensity() const { return _density; }
+		inline float GetFriction() const { return _friction; }
+		// Pose after the last completed physics step or the last teleport, body itself could be stepped right now
+		inline glm::vec2 GetPosition() const { return _position; }
 		// Returns rotation in radians
-		inline float GetAngle() { return _body->GetAngle(); }
+		inline float GetAngle() const { return _angle; }
+		// Body is created at the next physics sync point if component was added while physics world is stepped.
+		// Until then pose, velocity and forces are kept by component and applied to body once it's attached
 		inline b2Body* GetBody() { return _body; }
 
-		void SetDynamic(bool isDynamic);
+		// Pose before the last physics step, rendered pose is interpolated from it to the current one
+		inline glm::vec2 GetPreviousPosition() const { return _previousPosition; }
+		inline float GetPreviousAngle() const { return _previousAngle; }
+		// Body moved during the last physics step, so its rendered pose is interpolated
+		inline bool IsMoving() const { return _position != _previousPosition || _angle != _previousAngle; }
+		// Pose of completed physics step, the current pose becomes the previous one
+		void SetSimulatedPose(glm::vec2 position, float angleRadians);
+		// Pose that must not be interpolated from the old one. Body itself isn't moved
+		void SetPose(glm::vec2 position, float angleRadians);
+
+		void AttachBody(b2Body* body);
+		void SetType(Mango::RigidbodyType type);
 		void SetTransform(glm::vec2 position, float angleRadians);
-		void SetFixture(b2FixtureDef fixture);
+		// Replaces fixture of body, new fixture keeps density and friction of component
+		void SetShape(const b2Shape& shape);
+		// Density and friction are kept by component, so they survive fixture rebuilds
 		void SetDensity(float density);
 		void SetFriction(float friction);
 		void DestroyFixture();
 
 		void ApplyForce(glm::vec2 force);
+		// Velocity set explicitly is kept until it's changed, kinematic body isn't stopped at the next step
+		void SetVelocity(glm::vec2 velocity);
+
+		// Kinematic body is moved to its target by velocity during the next step instead of being teleported,
+		// so its contacts are kept. Target is initialized from the current pose, unset part of it isn't changed
+		void SetTargetPosition(glm::vec2 position);
+		void SetTargetAngle(float angleRadians);
+		inline bool HasTarget() const { return _hasTarget; }
+		// Called right before the step, sets velocity that reaches the target within time step
+		void DriveToTarget(float timeStep);
+		// Body driven during the previous step without a new target is stopped where it is
+		void StopDriving();
+
+		// Used by scene snapshots. Restored component owns a new body created in specified world
+		Mango::RigidbodyState GetState() const;
+		void RestoreState(b2World& world, const Mango::RigidbodyState& state);
 
 	private:
-		bool _isDynamic = true;
-		b2Body* _body;
+		Mango::RigidbodyType _type = Mango::RigidbodyType::Dynamic;
+		b2Body* _body = nullptr;
 		b2Fixture* _fixture = nullptr;
+		float _density = 1.0f;
+		float _friction = 0.3f;
+		glm::vec2 _position{ 0.0f };
+		float _angle = 0.0f;
+		glm::vec2 _previousPosition{ 0.0f };
+		float _previousAngle = 0.0f;
+
+		// Kinematic movement
+		glm::vec2 _targetPosition{ 0.0f };
+		float _targetAngle = 0.0f;
+		bool _hasTarget = false;
+		bool _isDriven = false;
+
+		// Movement requested before body was created
+		glm::vec2 _pendingVelocity{ 0.0f };
+		glm::vec2 _pendingForce{ 0.0f };
+		bool _hasPendingVelocity = false;
+
+	private:
+		static b2BodyType ToBodyType(Mango::RigidbodyType type);
 	};
 }
@@ -1,23 +1,21 @@
 #pragma once
 
-#include <cstdint>
-#include <string>
+#include "../StringPool.h"
+
+#include <string_view>
 
 namespace Mango
 {
+	// Script file name is stored in StringPool, component only keeps its handle
 	class ScriptComponent
 	{
 	public:
-		ScriptComponent();
-		~ScriptComponent();
-
-		inline char* GetFileName() { return _buffer; }
-		uint32_t GetBufferSize() { return _bufferSize; }
+		ScriptComponent() = default;
 
-		void SetFileName(std::string& fileName);
+		inline std::string_view GetFileName() const { return Mango::StringPool::Get(_fileNameHandle); }
+		void SetFileName(std::string_view fileName) { _fileNameHandle = Mango::StringPool::Intern(fileName); }
 
 	private:
-		const uint32_t _bufferSize = 128;
-		char* _buffer;
+		Mango::StringHandle _fileNameHandle = Mango::StringPool::EmptyHandle;
 	};
 }
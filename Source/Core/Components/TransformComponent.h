@@ -5,12 +5,17 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <entt/entity/entity.hpp>
+
+#include <cstdint>
+#include <vector>
 
 namespace Mango
 {
 	class TransformComponent
 	{
 	public:
+		TransformComponent() : TransformComponent(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f)) {}
 		TransformComponent(glm::vec3 translation, glm::vec3 rotation, glm::vec3 scale)
 		{
 			_translation = translation;
@@ -24,22 +29,87 @@ namespace Mango
 		inline glm::quat GetQuaternionRotation() { return glm::quat({ glm::radians(_rotation.x), glm::radians(_rotation.y), glm::radians(_rotation.z) }); }
 		inline glm::vec3 GetScale() { return _scale; }
 
-		void SetTranslation(glm::vec3 translation) { _translation = translation; }
+		// Setters only invalidate cached transform matrix when value actually changes
+		void SetTranslation(glm::vec3 translation) { if (translation != _translation) { _translation = translation; MarkDirty(); } }
 		// Rotation in degrees
-		void SetRotation(glm::vec3 rotation) { _rotation = rotation; }
-		void SetScale(glm::vec3 scale) { _scale = scale; }
+		void SetRotation(glm::vec3 rotation) { if (rotation != _rotation) { _rotation = rotation; MarkDirty(); } }
+		void SetScale(glm::vec3 scale) { if (scale != _scale) { _scale = scale; MarkDirty(); } }
+
+		inline bool IsDirty() const { return _isDirty; }
+
+		// Scene walks only transforms that changed. Entity is added to the list on its first change since it was taken off it.
+		// NOTE: setters of transforms attached to the same list must not be called concurrently
+		void AttachDirtyList(std::vector<entt::entity>* dirtyList, entt::entity entity)
+		{
+			_dirtyList = dirtyList;
+			_entity = entity;
+			_isListed = false;
+			if (_isDirty)
+			{
+				MarkDirty();
+			}
+		}
+		void TakeOffDirtyList() { _isListed = false; }
+
+		// Transform matrix is cached and only recomputed after translation, rotation or scale change
+		const glm::mat4& GetTransform()
+		{
+			if (_isDirty)
+			{
+				glm::mat4 rotation = glm::toMat4(GetQuaternionRotation());
+				_transform = glm::translate(glm::mat4(1.0f), _translation)
+					* rotation
+					* glm::scale(glm::mat4(1.0f), _scale);
+				_isDirty = false;
+				_version++;
+			}
+			return _transform;
+		}
+
+		// World transform of child entities is propagated by Scene from their parents.
+		// For root entities world transform is the same as local one
+		const glm::mat4& GetWorldTransform() { return _hasParent ? _worldTransform : GetTransform(); }
+		void SetWorldTransform(const glm::mat4& transform) { _worldTransform = transform; _version++; }
+		inline bool HasParent() const { return _hasParent; }
+		void SetHasParent(bool hasParent) { _hasParent = hasParent; _version++; }
 
-		glm::mat4 GetTransform()
+		// Store matrix composed outside of component, e.g. by TransformStore batch composition
+		void SetComposedTransform(const glm::mat4& transform)
 		{
-			glm::mat4 rotation = glm::toMat4(GetQuaternionRotation());
-			return glm::translate(glm::mat4(1.0f), _translation)
-				* rotation
-				* glm::scale(glm::mat4(1.0f), _scale);
+			_transform = transform;
+			_isDirty = false;
+			_version++;
 		}
 
+		// Incremented every time world transform matrix may have changed, renderer resends instances with changed version
+		inline uint32_t GetVersion() const { return _version; }
+
 	private:
 		glm::vec3 _translation;
 		glm::vec3 _scale;
 		glm::vec3 _rotation;
+
+		glm::mat4 _transform{ 1.0f };
+		bool _isDirty = true;
+
+		glm::mat4 _worldTransform{ 1.0f };
+		bool _hasParent = false;
+
+		uint32_t _version = 0;
+
+		std::vector<entt::entity>* _dirtyList = nullptr;
+		entt::entity _entity = entt::null;
+		bool _isListed = false;
+
+	private:
+		void MarkDirty()
+		{
+			_isDirty = true;
+			if (_dirtyList != nullptr && !_isListed)
+			{
+				_dirtyList->push_back(_entity);
+				_isListed = true;
+			}
+		}
 	};
 }
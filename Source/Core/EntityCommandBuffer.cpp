@@ -0,0 +1,16 @@
+#include "EntityCommandBuffer.h"
+
+#include <algorithm>
+
+std::vector<entt::entity>& Mango::EntityCommandBuffer::SortDestroyedEntities()
+{
+	std::sort(_destroyedEntities.begin(), _destroyedEntities.end());
+	_destroyedEntities.erase(std::unique(_destroyedEntities.begin(), _destroyedEntities.end()), _destroyedEntities.end());
+	return _destroyedEntities;
+}
+
+void Mango::EntityCommandBuffer::Clear()
+{
+	_commands.clear();
+	_destroyedEntities.clear();
+}
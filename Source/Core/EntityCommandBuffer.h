@@ -0,0 +1,47 @@
+#pragma once
+
+#include <entt/entity/entity.hpp>
+
+#include <vector>
+
+namespace Mango
+{
+	enum class EntityCommandType
+	{
+		AddRigidbody = 0,
+		RemoveRigidbody = 1
+	};
+
+	struct EntityCommand
+	{
+		Mango::EntityCommandType Type;
+		entt::entity Entity;
+	};
+
+	// Records structural changes of the registry requested while views are iterated or scripts are running.
+	// Scene plays them back in one batch at sync points. Component changes are applied in the order
+	// they were recorded, destroys are applied after them
+	class EntityCommandBuffer
+	{
+	public:
+		EntityCommandBuffer() = default;
+		EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+		EntityCommandBuffer operator=(const EntityCommandBuffer&) = delete;
+
+		void Destroy(entt::entity entity) { _destroyedEntities.push_back(entity); }
+		void AddRigidbody(entt::entity entity) { _commands.push_back({ Mango::EntityCommandType::AddRigidbody, entity }); }
+		void RemoveRigidbody(entt::entity entity) { _commands.push_back({ Mango::EntityCommandType::RemoveRigidbody, entity }); }
+
+		inline bool IsEmpty() const { return _commands.empty() && _destroyedEntities.empty(); }
+		inline const std::vector<Mango::EntityCommand>& GetCommands() const { return _commands; }
+
+		// Returns destroyed entities sorted by their identifiers without duplicates
+		std::vector<entt::entity>& SortDestroyedEntities();
+
+		void Clear();
+
+	private:
+		std::vector<Mango::EntityCommand> _commands;
+		std::vector<entt::entity> _destroyedEntities;
+	};
+}
@@ -1,8 +1,7 @@
 #include "GUID.h"
 
-std::random_device Mango::GUID::_randomDevice{};
-std::mt19937_64 Mango::GUID::_generator{ _randomDevice() };
-std::uniform_int_distribution<uint64_t> Mango::GUID::_distribution{ 0, std::numeric_limits<uint64_t>::max() };
+thread_local std::mt19937_64 Mango::GUID::_generator{ std::random_device{}() };
+thread_local std::uniform_int_distribution<uint64_t> Mango::GUID::_distribution{ 0, std::numeric_limits<uint64_t>::max() };
 
 uint64_t Mango::GUID::GetNext()
 {
@@ -21,9 +21,9 @@ namespace Mango
 		GUID& operator=(const GUID&) = default;
 
 	private:
-		static std::random_device _randomDevice;
-		static std::mt19937_64 _generator;
-		static std::uniform_int_distribution<unsigned long long> _distribution;
+		// Every thread has its own generator, so entities could be created on background threads
+		static thread_local std::mt19937_64 _generator;
+		static thread_local std::uniform_int_distribution<unsigned long long> _distribution;
 
 	private:
 		uint64_t _id;
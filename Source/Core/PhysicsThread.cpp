@@ -0,0 +1,119 @@
+#include "PhysicsThread.h"
+
+#include <algorithm>
+
+Mango::PhysicsThread::PhysicsThread(b2World& world, float timeStep, int32_t velocityIterations, int32_t positionIterations)
+	: _world(world), _timeStep(timeStep), _velocityIterations(velocityIterations), _positionIterations(positionIterations)
+{
+}
+
+Mango::PhysicsThread::~PhysicsThread()
+{
+	if (!_thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopRequested = true;
+	}
+	_condition.notify_all();
+	_thread.join();
+}
+
+void Mango::PhysicsThread::BeginStep()
+{
+	// Staging scenes are never stepped, so thread is only started by scene that is played
+	if (!_thread.joinable())
+	{
+		_thread = std::thread(&Mango::PhysicsThread::Run, this);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stepRequested = true;
+	}
+	_condition.notify_all();
+	_isStepping = true;
+}
+
+void Mango::PhysicsThread::Wait()
+{
+	if (!_isStepping)
+	{
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_condition.wait(lock, [this]() { return !_stepRequested; });
+	}
+	_isStepping = false;
+	_readBuffer = 1 - _readBuffer;
+}
+
+void Mango::PhysicsThread::ClearBodies()
+{
+	_destroyedBodies.clear();
+	_awakeBodies.clear();
+}
+
+void Mango::PhysicsThread::Run()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this]() { return _stopRequested || _stepRequested; });
+			if (_stopRequested)
+			{
+				return;
+			}
+		}
+
+		// Destroyed bodies are only compared by address, they are never dereferenced
+		if (!_destroyedBodies.empty())
+		{
+			std::sort(_destroyedBodies.begin(), _destroyedBodies.end());
+			std::erase_if(_awakeBodies, [this](b2Body* body) { return std::binary_search(_destroyedBodies.begin(), _destroyedBodies.end(), body); });
+			_destroyedBodies.clear();
+		}
+
+		_world.Step(_timeStep, _velocityIterations, _positionIterations);
+
+		// Box2D has no list of awake bodies, so flags are checked here instead of on the thread that consumes poses.
+		// Static bodies are never awake, they are only moved by teleports which already update their entities
+		auto& poses = _poses[1 - _readBuffer];
+		poses.clear();
+		_nextAwakeBodies.clear();
+		for (b2Body* body = _world.GetBodyList(); body != nullptr; body = body->GetNext())
+		{
+			if (!body->IsAwake())
+			{
+				continue;
+			}
+
+			const b2Vec2& position = body->GetPosition();
+			poses.push_back({ body, Mango::GUID(body->GetUserData().pointer), glm::vec2(position.x, position.y), body->GetAngle(), false });
+			_nextAwakeBodies.push_back(body);
+		}
+
+		// Bodies put to sleep by this step still moved during it
+		for (b2Body* body : _awakeBodies)
+		{
+			if (!body->IsAwake())
+			{
+				const b2Vec2& position = body->GetPosition();
+				poses.push_back({ body, Mango::GUID(body->GetUserData().pointer), glm::vec2(position.x, position.y), body->GetAngle(), true });
+			}
+		}
+		std::swap(_awakeBodies, _nextAwakeBodies);
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stepRequested = false;
+		}
+		_condition.notify_all();
+	}
+}
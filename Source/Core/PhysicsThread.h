@@ -0,0 +1,107 @@
+#pragma once
+
+#include "GUID.h"
+#include "RigidbodyType.h"
+
+#include <entt/entity/entity.hpp>
+#include <glm/glm.hpp>
+#include <box2d/box2d.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mango
+{
+	enum class PhysicsCommandType
+	{
+		CreateBody = 0,
+		DestroyBody = 1,
+		ApplyForce = 2,
+		SetTransform = 3,
+		SetType = 4,
+		SetDensity = 5,
+		SetFriction = 6,
+		SetVelocity = 7
+	};
+
+	// Change of physics world requested while it's stepped, applied before the next step
+	struct PhysicsCommand
+	{
+		Mango::PhysicsCommandType Type;
+		entt::entity Entity = entt::null;
+		// Only used by DestroyBody, entity of destroyed body could be already gone
+		b2Body* Body = nullptr;
+		// Force, position or velocity
+		glm::vec2 Vector{ 0.0f };
+		// Angle in radians, density or friction
+		float Value = 0.0f;
+		Mango::RigidbodyType BodyType = Mango::RigidbodyType::Dynamic;
+	};
+
+	// Pose of body after completed step
+	struct BodyPose
+	{
+		b2Body* Body;
+		Mango::GUID EntityId;
+		glm::vec2 Position;
+		float Angle;
+		// Body fell asleep during the step, its pose won't change until it's woken up
+		bool IsAsleep;
+	};
+
+	// Steps physics world on its own thread, so the step overlaps with the rest of the frame.
+	// World must not be touched by any other thread from BeginStep until Wait returns.
+	// Poses are written into one buffer while the other one keeps poses of the last completed step.
+	// Only awake bodies and bodies that fell asleep during the step get poses, sleeping bodies are skipped
+	class PhysicsThread
+	{
+	public:
+		PhysicsThread(b2World& world, float timeStep, int32_t velocityIterations, int32_t positionIterations);
+		PhysicsThread(const PhysicsThread&) = delete;
+		PhysicsThread operator=(const PhysicsThread&) = delete;
+		~PhysicsThread();
+
+		// Returns immediately, thread is started with the first step
+		void BeginStep();
+		// Blocks until started step is completed, returns immediately if no step was started
+		void Wait();
+		inline bool IsStepping() const { return _isStepping; }
+
+		// Poses of bodies that moved during the last completed step
+		inline const std::vector<Mango::BodyPose>& GetPoses() const { return _poses[_readBuffer]; }
+
+		// Must be called for every body destroyed between steps, before it's destroyed
+		void OnBodyDestroyed(b2Body* body) { _destroyedBodies.push_back(body); }
+		// Forget all bodies after whole world was cleared
+		void ClearBodies();
+
+	private:
+		b2World& _world;
+		const float _timeStep;
+		const int32_t _velocityIterations;
+		const int32_t _positionIterations;
+
+		// Only accessed by thread that starts steps
+		bool _isStepping = false;
+		uint32_t _readBuffer = 0;
+		std::vector<Mango::BodyPose> _poses[2];
+
+		// Only accessed by physics thread, or by thread that starts steps while no step is running
+		std::vector<b2Body*> _destroyedBodies;
+		std::vector<b2Body*> _awakeBodies;
+		std::vector<b2Body*> _nextAwakeBodies;
+
+		// Guarded by mutex
+		std::thread _thread;
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		bool _stepRequested = false;
+		bool _stopRequested = false;
+
+	private:
+		void Run();
+	};
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "GeometryType.h"
+#include "RigidbodyType.h"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include <optional>
+#include <string>
+
+namespace Mango
+{
+	// Template of an entity. Every instance gets IdComponent, NameComponent and TransformComponent,
+	// other components are added only if prefab defines their default values
+	struct Prefab
+	{
+		// Prefab name, also used as name of every instance
+		std::string Name;
+
+		glm::vec3 Translation = glm::vec3(0.0f, 0.0f, 0.0f);
+		// Rotation in degrees
+		glm::vec3 Rotation = glm::vec3(0.0f, 0.0f, 0.0f);
+		glm::vec3 Scale = glm::vec3(1.0f, 1.0f, 1.0f);
+
+		std::optional<glm::vec4> Color;
+		std::optional<Mango::GeometryType> Geometry;
+		// Value is type of rigidbody body
+		std::optional<Mango::RigidbodyType> Rigidbody;
+		std::optional<std::string> ScriptFileName;
+	};
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace Mango
+{
+	// Static and dynamic values match the "is dynamic" flag scenes were saved with before
+	enum class RigidbodyType
+	{
+		Static = 0,
+		Dynamic = 1,
+		// Moved by its velocity only, it isn't affected by forces and collisions
+		Kinematic = 2
+	};
+}
@@ -1,19 +1,79 @@
 #include "Scene.h"
 
 #include "../Infrastructure/Logging/Logging.h"
+#include "../Infrastructure/Jobs/JobSystem.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <unordered_map>
 
 Mango::Scene::Scene(Mango::Renderer& renderer)
     : _renderer(renderer)
 {
-    _scriptEngine = std::make_unique<Mango::ScriptEngine>();
-    _collisionListener = std::make_unique<CollisionListener>(_scriptEngine.get());
+    _registry.on_construct<IdComponent>().connect<&Mango::Scene::OnIdComponentConstruct>(*this);
+    _registry.on_update<IdComponent>().connect<&Mango::Scene::OnIdComponentUpdate>(*this);
+    _registry.on_destroy<IdComponent>().connect<&Mango::Scene::OnIdComponentDestroy>(*this);
+    _registry.on_construct<NameComponent>().connect<&Mango::Scene::OnNameComponentConstruct>(*this);
+    _registry.on_update<NameComponent>().connect<&Mango::Scene::OnNameComponentUpdate>(*this);
+    _registry.on_destroy<NameComponent>().connect<&Mango::Scene::OnNameComponentDestroy>(*this);
+    _registry.on_destroy<RelationshipComponent>().connect<&Mango::Scene::OnRelationshipComponentDestroy>(*this);
+    _registry.on_construct<TransformComponent>().connect<&Mango::Scene::OnTransformComponentConstruct>(*this);
+
+    // Renderables group is created before any entity exists and gets repartitioned whenever triangles join or leave it
+    _registry.group<TransformComponent, ColorComponent, GeometryComponent>();
+    _registry.on_construct<TransformComponent>().connect<&Mango::Scene::OnRenderableChanged>(*this);
+    _registry.on_destroy<TransformComponent>().connect<&Mango::Scene::OnRenderableChanged>(*this);
+    _registry.on_construct<ColorComponent>().connect<&Mango::Scene::OnRenderableChanged>(*this);
+    _registry.on_destroy<ColorComponent>().connect<&Mango::Scene::OnRenderableChanged>(*this);
+    _registry.on_construct<GeometryComponent>().connect<&Mango::Scene::OnRenderableChanged>(*this);
+    _registry.on_destroy<GeometryComponent>().connect<&Mango::Scene::OnRenderableChanged>(*this);
+
+    // Built-in prefabs used by editor and by scripts
+    Mango::Prefab triangle;
+    triangle.Name = "Triangle";
+    triangle.Color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    triangle.Geometry = Mango::GeometryType::Triangle;
+    RegisterPrefab(triangle);
+
+    Mango::Prefab rectangle;
+    rectangle.Name = "Rectangle";
+    rectangle.Color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    rectangle.Geometry = Mango::GeometryType::Rectangle;
+    RegisterPrefab(rectangle);
+
+    _collisionListener = std::make_unique<CollisionListener>();
     _physicsWorld.SetContactListener(_collisionListener.get());
 }
 
 Mango::Scene::~Scene()
+{
+    // Loader thread of streamed world and physics step are stopped before anything they read is destroyed
+    _worldStreamer = nullptr;
+    _physicsThread.Wait();
+
+    _registry.on_construct<IdComponent>().disconnect(*this);
+    _registry.on_update<IdComponent>().disconnect(*this);
+    _registry.on_destroy<IdComponent>().disconnect(*this);
+    _registry.on_construct<NameComponent>().disconnect(*this);
+    _registry.on_update<NameComponent>().disconnect(*this);
+    _registry.on_destroy<NameComponent>().disconnect(*this);
+    _registry.on_destroy<RelationshipComponent>().disconnect(*this);
+    _registry.on_construct<TransformComponent>().disconnect(*this);
+    _registry.on_destroy<TransformComponent>().disconnect(*this);
+    _registry.on_construct<ColorComponent>().disconnect(*this);
+    _registry.on_destroy<ColorComponent>().disconnect(*this);
+    _registry.on_construct<GeometryComponent>().disconnect(*this);
+    _registry.on_destroy<GeometryComponent>().disconnect(*this);
+
+    _scriptEngine = nullptr;
+}
+
+void Mango::Scene::CreateScriptEngine()
+{
+    _scriptEngine = std::make_unique<Mango::ScriptEngine>();
+}
+
+void Mango::Scene::DestroyScriptEngine()
 {
     _scriptEngine = nullptr;
 }
@@ -44,21 +104,91 @@ void Mango::Scene::OnCreate()
     }
 }
 
-void Mango::Scene::OnUpdate()
+void Mango::Scene::OnUpdate(float deltaTime, float interpolationAlpha)
 {
-    // Render
-    auto view = _registry.view<TransformComponent, ColorComponent, GeometryComponent>();
-    for (auto [entity, transform, color, geometry] : view.each())
+    _deltaTime = deltaTime;
+    _interpolationAlpha = interpolationAlpha;
+
+    // Streamed chunks are added and removed at frame start, before any view is created
+    if (_worldStreamer != nullptr)
     {
-        if (geometry.GetGeometry() == Mango::GeometryType::Triangle)
-        {
-            _renderer.DrawTriangle(transform.GetTransform(), color.GetColor());
-        }
-        if (geometry.GetGeometry() == Mango::GeometryType::Rectangle)
+        _worldStreamer->Update();
+    }
+
+    UpdateTransforms();
+
+    // Render. Group owns all renderable storages, so components are iterated as packed arrays
+    // Position in group is the instance slot, slots whose entity changed are rewritten below
+    auto renderables = _registry.group<TransformComponent, ColorComponent, GeometryComponent>();
+    if (_renderablesOrderDirty)
+    {
+        PartitionRenderables();
+    }
+    if (_renderablesOrderDirty || _drawList.GetInstancesCount() != renderables.size())
+    {
+        _drawList.Resize(_trianglesCount, renderables.size() - _trianglesCount);
+        _instanceVersions.resize(renderables.size());
+        _renderablesOrderDirty = false;
+    }
+
+    // Only instances whose transform or color version changed since they were sent are extracted.
+    // Every chunk collects changed slots into its own list, lists are concatenated in chunk order afterwards
+    const size_t instancesCount = renderables.size();
+    const size_t chunksCount = (instancesCount + _extractionGrainSize - 1) / _extractionGrainSize;
+    if (_changedSlotsPerChunk.size() < chunksCount)
+    {
+        _changedSlotsPerChunk.resize(chunksCount);
+    }
+
+    // During play physics bodies are drawn between their last two simulated poses
+    auto& rigidbodies = _registry.storage<RigidbodyComponent>();
+    const bool interpolate = _sceneState == Mango::SceneState::Play;
+    const float alpha = _interpolationAlpha;
+    const auto entities = renderables.begin();
+    Mango::DrawItem* items = _drawList.GetItems();
+    InstanceVersion* versions = _instanceVersions.data();
+
+    Mango::JobSystem::ParallelFor(chunksCount, 1, [&](size_t beginChunk, size_t endChunk)
+    {
+        for (size_t chunk = beginChunk; chunk < endChunk; chunk++)
         {
-            _renderer.DrawRect(transform.GetTransform(), color.GetColor());
+            auto& changedSlots = _changedSlotsPerChunk[chunk];
+            changedSlots.clear();
+
+            const size_t end = std::min((chunk + 1) * _extractionGrainSize, instancesCount);
+            for (size_t i = chunk * _extractionGrainSize; i < end; i++)
+            {
+                const entt::entity entity = entities[i];
+                auto [transform, color] = renderables.get<TransformComponent, ColorComponent>(entity);
+                const glm::mat4& worldTransform = transform.GetWorldTransform();
+                // Bodies that didn't move during the last step are drawn at their transform and aren't resent
+                const bool interpolated = interpolate && !transform.HasParent() && rigidbodies.contains(entity) && rigidbodies.get(entity).IsMoving();
+                const InstanceVersion version{ entity, transform.GetVersion(), color.GetVersion(), interpolated };
+                if (!interpolated && !versions[i].Interpolated && versions[i].Entity == entity && versions[i].Transform == version.Transform && versions[i].Color == version.Color)
+                {
+                    continue;
+                }
+
+                if (interpolated)
+                {
+                    items[i] = Mango::DrawItem{ InterpolateBodyTransform(transform, rigidbodies.get(entity), alpha), color.GetColor() };
+                }
+                else
+                {
+                    items[i] = Mango::DrawItem{ worldTransform, color.GetColor() };
+                }
+                versions[i] = version;
+                changedSlots.push_back(static_cast<uint32_t>(i));
+            }
         }
+    });
+
+    _drawList.ClearChangedSlots();
+    for (size_t i = 0; i < chunksCount; i++)
+    {
+        _drawList.AddChangedSlots(_changedSlotsPerChunk[i]);
     }
+    _renderer.SubmitDrawList(_drawList);
 
     // Update camera views
     auto camerasView = _registry.view<CameraComponent, TransformComponent>();
@@ -81,6 +211,7 @@ void Mango::Scene::OnUpdate()
     }
 
     _scriptEngine->OnUpdate();
+    PlaybackCommands();
 }
 
 void Mango::Scene::OnFixedUpdate()
@@ -90,20 +221,18 @@ void Mango::Scene::OnFixedUpdate()
         return;
     }
 
-    _physicsWorld.Step(_timeStep, _velocityIterations, _positionIterations);
-    
-    auto view = _registry.view<TransformComponent, RigidbodyComponent>();
-    for (auto [entity, transform, rigidbody] : view.each())
-    {
-        auto position = rigidbody.GetPosition();
-        float angle = rigidbody.GetAngle();
-        auto currentTranslation = transform.GetTranslation();
-        transform.SetTranslation(glm::vec3(position, currentTranslation.z));
-        auto currentRotation = transform.GetRotation();
-        transform.SetRotation(glm::vec3(currentRotation.x, currentRotation.y, glm::degrees(angle)));
-    }
+    // Step started by the previous fixed update has run while the frame was rendered
+    SyncPhysics();
+    DeliverCollisionEvents();
 
+    _isFixedUpdating = true;
     _scriptEngine->OnFixedUpdate();
+    _isFixedUpdating = false;
+    PlaybackCommands();
+
+    RebuildFixtures();
+    DriveKinematicBodies();
+    _physicsThread.BeginStep();
 }
 
 void Mango::Scene::OnPlay()
@@ -131,25 +260,24 @@ void Mango::Scene::OnPlay()
     }
 
     // Setup rigidbodies
-    for (auto [_, transform, rigidbody] : _registry.view<TransformComponent, RigidbodyComponent>().each())
+    for (auto [entity, transform, rigidbody] : _registry.view<TransformComponent, RigidbodyComponent>().each())
     {
+        // Body that isn't created yet gets its transform and fixture once it's created
+        if (rigidbody.GetBody() == nullptr)
+        {
+            continue;
+        }
+
         auto translation = transform.GetTranslation();
         auto rotation = transform.GetRotation().z;
-        auto scale = transform.GetScale();
-
         rigidbody.SetTransform(glm::vec2(translation.x, translation.y), glm::radians(rotation));
-        b2PolygonShape bodyBox;
-        bodyBox.SetAsBox(scale.x, scale.y);
-        b2FixtureDef fixtureDefinition;
-        fixtureDefinition.shape = &bodyBox;
-        fixtureDefinition.density = 1.0f;
-        fixtureDefinition.friction = 0.3f;
-        rigidbody.SetFixture(fixtureDefinition);
+        RebuildFixture(entity, rigidbody);
     }
 
     // Setup ScriptEngine
     std::filesystem::path scriptsPath = std::filesystem::current_path();
-    std::unordered_map<std::string, std::filesystem::path> scripts;
+    auto& scripts = _scriptPaths;
+    scripts.clear();
     for (const auto& entry : std::filesystem::directory_iterator(scriptsPath))
     {
         if (!entry.is_regular_file())
@@ -189,7 +317,13 @@ void Mango::Scene::OnPlay()
     _scriptEngine->SetDestroyEntityEventHandler(DestroyEntity);
     _scriptEngine->SetSetRigidEntityEventHandler(SetRigid);
     _scriptEngine->SetConfigureRigidbodyEventHandler(ConfigureRigidbody);
+    _scriptEngine->SetSetVelocityEventHandler(SetVelocity);
     _scriptEngine->SetFindEntityByNameEventHandler(FindEntityByName);
+    _scriptEngine->SetSetParentEventHandler(SetParent);
+    _scriptEngine->SetInstantiatePrefabEventHandler(InstantiatePrefabByName);
+    _scriptEngine->SetGetDeltaTimeEventHandler(GetDeltaTime);
+    _scriptEngine->SetGetFixedDeltaTimeEventHandler(GetFixedDeltaTime);
+    _scriptEngine->SetGetInterpolationAlphaEventHandler(GetInterpolationAlpha);
 
     try
     {
@@ -212,6 +346,7 @@ void Mango::Scene::OnStop()
     }
 
     _sceneState = Mango::SceneState::Stop;
+    SyncPhysics();
 
     auto camerasView = _registry.view<CameraComponent, TransformComponent>();
     for (auto [entity, camera, transform] : camerasView.each())
@@ -224,20 +359,26 @@ void Mango::Scene::OnStop()
     }
 
     // Dispose rigidbodies
+    _fixtureRebuilds.clear();
+    _kinematicTargets.clear();
+    _drivenBodies.clear();
     for (auto [_, rigidbody] : _registry.view<RigidbodyComponent>().each())
     {
         rigidbody.DestroyFixture();
     }
+
+    // Contacts of the last step and contacts ended by destroyed fixtures are never delivered
+    _collisionListener->ClearEvents();
 }
 
 void Mango::Scene::AddTriangle()
 {
-    AddDefaultEntity(Mango::GeometryType::Triangle);
+    AddDefaultEntity(*FindPrefab("Triangle"));
 }
 
 void Mango::Scene::AddRectangle()
 {
-    AddDefaultEntity(Mango::GeometryType::Rectangle);
+    AddDefaultEntity(*FindPrefab("Rectangle"));
 }
 
 entt::entity Mango::Scene::AddCamera()
@@ -257,27 +398,13 @@ void Mango::Scene::AddRigidbody(entt::entity entity)
         return;
     }
 
-    auto& id = _registry.get<IdComponent>(entity).GetId();
-
-    b2BodyDef bodyDefinition;
-    bodyDefinition.userData.pointer = reinterpret_cast<uintptr_t>(&id);
-    b2Body* body = _physicsWorld.CreateBody(&bodyDefinition);
-    
-    auto& rigidbody = _registry.emplace<RigidbodyComponent>(entity, body);
+    auto& rigidbody = _registry.emplace<RigidbodyComponent>(entity);
     auto& transform = _registry.get<TransformComponent>(entity);
+    rigidbody.SetPose(glm::vec2(transform.GetTranslation()), glm::radians(transform.GetRotation().z));
 
-    auto translation = transform.GetTranslation();
-    auto rotation = transform.GetRotation().z;
-    auto scale = transform.GetScale();
-
-    rigidbody.SetTransform(glm::vec2(translation.x, translation.y), glm::radians(rotation));
-    b2PolygonShape bodyBox;
-    bodyBox.SetAsBox(scale.x, scale.y);
-    b2FixtureDef fixtureDefinition;
-    fixtureDefinition.shape = &bodyBox;
-    fixtureDefinition.density = 1.0f;
-    fixtureDefinition.friction = 0.3f;
-    rigidbody.SetFixture(fixtureDefinition);
+    Mango::PhysicsCommand command{ Mango::PhysicsCommandType::CreateBody };
+    command.Entity = entity;
+    SubmitPhysicsCommand(command);
 }
 
 void Mango::Scene::AddScript(entt::entity entity)
@@ -291,9 +418,214 @@ void Mango::Scene::AddScript(entt::entity entity)
     _registry.emplace<ScriptComponent>(entity);
 }
 
+void Mango::Scene::RemoveRigidbody(entt::entity entity)
+{
+    auto rigidbody = _registry.try_get<RigidbodyComponent>(entity);
+    if (rigidbody == nullptr)
+    {
+        return;
+    }
+
+    if (rigidbody->GetBody() != nullptr)
+    {
+        Mango::PhysicsCommand command{ Mango::PhysicsCommandType::DestroyBody };
+        command.Body = rigidbody->GetBody();
+        SubmitPhysicsCommand(command);
+    }
+    _registry.remove<RigidbodyComponent>(entity);
+}
+
+void Mango::Scene::SetRigidbodyType(entt::entity entity, Mango::RigidbodyType type)
+{
+    if (!_registry.all_of<RigidbodyComponent>(entity))
+    {
+        return;
+    }
+
+    Mango::PhysicsCommand command{ Mango::PhysicsCommandType::SetType };
+    command.Entity = entity;
+    command.BodyType = type;
+    SubmitPhysicsCommand(command);
+}
+
 void Mango::Scene::DeleteEntity(entt::entity entity)
 {
-    _registry.destroy(entity);
+    // Editor deletes entities while it iterates over them
+    _commandBuffer.Destroy(entity);
+}
+
+void Mango::Scene::OpenWorld(const std::filesystem::path& manifestPath)
+{
+    CloseWorld();
+    _worldStreamer = std::make_unique<Mango::WorldStreamer>(*this, manifestPath);
+}
+
+void Mango::Scene::CloseWorld()
+{
+    if (_worldStreamer == nullptr)
+    {
+        return;
+    }
+
+    _worldStreamer = nullptr;
+    for (auto entity : _registry.view<ChunkComponent>())
+    {
+        DeleteEntity(entity);
+    }
+}
+
+void Mango::Scene::RegisterPrefab(const Mango::Prefab& prefab)
+{
+    _prefabs[Mango::StringPool::Intern(prefab.Name)] = prefab;
+}
+
+const Mango::Prefab* Mango::Scene::FindPrefab(std::string_view name)
+{
+    Mango::StringHandle nameHandle;
+    if (!Mango::StringPool::Find(name, &nameHandle))
+    {
+        return nullptr;
+    }
+
+    auto it = _prefabs.find(nameHandle);
+    return it != _prefabs.end() ? &it->second : nullptr;
+}
+
+void Mango::Scene::InstantiatePrefab(const Mango::Prefab& prefab, size_t count, std::vector<entt::entity>& entities)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto first = entities.size();
+    entities.resize(first + count);
+    const auto begin = entities.begin() + first;
+    const auto end = entities.end();
+    _registry.create(begin, end);
+
+    // Every instance needs its own GUID, the rest of components share prefab values
+    std::vector<IdComponent> ids(count);
+    _registry.insert<IdComponent>(begin, end, ids.begin());
+    _registry.insert<NameComponent>(begin, end, NameComponent(prefab.Name));
+    _registry.insert<TransformComponent>(begin, end, TransformComponent(prefab.Translation, prefab.Rotation, prefab.Scale));
+    if (prefab.Color.has_value())
+    {
+        _registry.insert<ColorComponent>(begin, end, ColorComponent(prefab.Color.value()));
+    }
+    if (prefab.Geometry.has_value())
+    {
+        _registry.insert<GeometryComponent>(begin, end, GeometryComponent(prefab.Geometry.value()));
+    }
+
+    // Every rigidbody owns its own Box2D body, so they can't be inserted in bulk
+    if (prefab.Rigidbody.has_value())
+    {
+        for (auto it = begin; it != end; it++)
+        {
+            AddRigidbody(*it);
+            SetRigidbodyType(*it, prefab.Rigidbody.value());
+        }
+    }
+
+    if (prefab.ScriptFileName.has_value())
+    {
+        ScriptComponent script;
+        script.SetFileName(prefab.ScriptFileName.value());
+        _registry.insert<ScriptComponent>(begin, end, script);
+
+        // Entities spawned while scene is playing queue their scripts, instances are created on next script update
+        auto scriptPath = _scriptPaths.find(prefab.ScriptFileName.value());
+        if (_sceneState == Mango::SceneState::Play && scriptPath != _scriptPaths.end())
+        {
+            for (auto it = begin; it != end; it++)
+            {
+                _scriptEngine->AttachScript(_registry.get<IdComponent>(*it).GetId(), scriptPath->second);
+            }
+        }
+    }
+}
+
+void Mango::Scene::SetEntityName(entt::entity entity, std::string_view name)
+{
+    _registry.patch<NameComponent>(entity, [&name](auto& component) { component.SetName(name); });
+}
+
+bool Mango::Scene::SetEntityParent(entt::entity entity, entt::entity parent)
+{
+    if (entity == parent)
+    {
+        return false;
+    }
+
+    // Entity can't be attached to one of its own descendants
+    for (auto ancestor = parent; ancestor != entt::null;)
+    {
+        if (ancestor == entity)
+        {
+            return false;
+        }
+        auto ancestorRelationship = _registry.try_get<RelationshipComponent>(ancestor);
+        ancestor = ancestorRelationship != nullptr ? ancestorRelationship->GetParent() : entt::null;
+    }
+
+    // Make sure both components exist before taking references to them
+    if (parent != entt::null)
+    {
+        _registry.get_or_emplace<RelationshipComponent>(parent);
+    }
+    auto& relationship = _registry.get_or_emplace<RelationshipComponent>(entity);
+    if (relationship.GetParent() == parent)
+    {
+        return true;
+    }
+
+    UnlinkFromParent(entity, relationship);
+
+    uint32_t depth = 0;
+    if (parent != entt::null)
+    {
+        // New child becomes the first one in parent's children list
+        auto& parentRelationship = _registry.get<RelationshipComponent>(parent);
+        const auto nextSibling = parentRelationship.GetFirstChild();
+        if (nextSibling != entt::null)
+        {
+            _registry.get<RelationshipComponent>(nextSibling).SetPreviousSibling(entity);
+        }
+        relationship.SetNextSibling(nextSibling);
+        parentRelationship.SetFirstChild(entity);
+        parentRelationship.SetChildrenCount(parentRelationship.GetChildrenCount() + 1);
+        depth = parentRelationship.GetDepth() + 1;
+    }
+    relationship.SetParent(parent);
+    _registry.get<TransformComponent>(entity).SetHasParent(parent != entt::null);
+
+    UpdateSubtreeDepth(entity, depth);
+    _dirtyHierarchyRoots.push_back(entity);
+    return true;
+}
+
+void Mango::Scene::SetParent(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, Mango::GUID parentId)
+{
+    Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
+    auto& registry = scene->GetRegistry();
+    auto entity = scene->GetEntityById(entityId);
+    if (!registry.valid(entity))
+    {
+        return;
+    }
+
+    entt::entity parent = entt::null;
+    if (parentId != Mango::GUID::Empty())
+    {
+        parent = scene->GetEntityById(parentId);
+        if (!registry.valid(parent))
+        {
+            return;
+        }
+    }
+
+    scene->SetEntityParent(entity, parent);
 }
 
 void Mango::Scene::ApplyForce(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, glm::vec2 force)
@@ -306,12 +638,15 @@ void Mango::Scene::ApplyForce(Mango::ScriptEngine* scriptEngine, Mango::GUID ent
         return;
     }
 
-    auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
-    if (rigidbody == nullptr)
+    if (!registry.all_of<RigidbodyComponent>(entity))
     {
         return;
     }
-    rigidbody->ApplyForce(force);
+
+    Mango::PhysicsCommand command{ Mango::PhysicsCommandType::ApplyForce };
+    command.Entity = entity;
+    command.Vector = force;
+    scene->SubmitPhysicsCommand(command);
 }
 
 glm::vec2 Mango::Scene::GetPosition(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId)
@@ -339,15 +674,28 @@ void Mango::Scene::SetPosition(Mango::ScriptEngine* scriptEngine, Mango::GUID en
         return;
     }
 
+    // Kinematic body moves to new position during the next step, its transform follows simulated pose
+    auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
+    if (rigidbody != nullptr && rigidbody->GetType() == Mango::RigidbodyType::Kinematic)
+    {
+        rigidbody->SetTargetPosition(transform);
+        scene->_kinematicTargets.push_back(entity);
+        return;
+    }
+
     auto& transformComponent = registry.get<TransformComponent>(entity);
     auto zPosition = transformComponent.GetTranslation().z;
     transformComponent.SetTranslation(glm::vec3(transform, zPosition));
     
-    auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
     if (rigidbody != nullptr)
     {
-        float angleRadians = glm::radians(transformComponent.GetRotation().z);
-        rigidbody->SetTransform(transform, angleRadians);
+        // Entity is drawn at teleported pose right away, body is moved before the next step
+        Mango::PhysicsCommand command{ Mango::PhysicsCommandType::SetTransform };
+        command.Entity = entity;
+        command.Vector = transform;
+        command.Value = glm::radians(transformComponent.GetRotation().z);
+        rigidbody->SetPose(command.Vector, command.Value);
+        scene->SubmitPhysicsCommand(command);
     }
 }
 
@@ -368,6 +716,24 @@ glm::vec2 Mango::Scene::GetMouseCursorPosition(Mango::ScriptEngine* scriptEngine
     return Mango::Input::GetMouseCursorPosition();
 }
 
+float Mango::Scene::GetDeltaTime(Mango::ScriptEngine* scriptEngine)
+{
+    Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
+    return scene->_isFixedUpdating ? scene->_timeStep : scene->_deltaTime;
+}
+
+float Mango::Scene::GetFixedDeltaTime(Mango::ScriptEngine* scriptEngine)
+{
+    Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
+    return scene->_timeStep;
+}
+
+float Mango::Scene::GetInterpolationAlpha(Mango::ScriptEngine* scriptEngine)
+{
+    Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
+    return scene->_interpolationAlpha;
+}
+
 float Mango::Scene::GetRotation(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId)
 {
     Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
@@ -392,14 +758,26 @@ void Mango::Scene::SetRotation(Mango::ScriptEngine* scriptEngine, Mango::GUID en
         return;
     }
 
+    auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
+    if (rigidbody != nullptr && rigidbody->GetType() == Mango::RigidbodyType::Kinematic)
+    {
+        rigidbody->SetTargetAngle(glm::radians(rotation));
+        scene->_kinematicTargets.push_back(entity);
+        return;
+    }
+
     auto& transform = registry.get<TransformComponent>(entity);
     auto r = transform.GetRotation();
     transform.SetRotation(glm::vec3(r.x, r.y, rotation));
 
-    auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
     if (rigidbody != nullptr)
     {
-        rigidbody->SetTransform(rigidbody->GetPosition(), glm::radians(rotation));
+        Mango::PhysicsCommand command{ Mango::PhysicsCommandType::SetTransform };
+        command.Entity = entity;
+        command.Vector = rigidbody->GetPosition();
+        command.Value = glm::radians(rotation);
+        rigidbody->SetPose(command.Vector, command.Value);
+        scene->SubmitPhysicsCommand(command);
     }
 }
 
@@ -432,57 +810,54 @@ void Mango::Scene::SetScale(Mango::ScriptEngine* scriptEngine, Mango::GUID entit
     auto scaleZ = transform.GetScale().z;
     transform.SetScale(glm::vec3(scale, scaleZ));
 
-    auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
-    if (rigidbody != nullptr)
+    // Scale could change many times before the next step, fixture is rebuilt once for the last one
+    if (registry.all_of<RigidbodyComponent>(entity))
     {
-        rigidbody->DestroyFixture();
-
-        b2PolygonShape bodyBox;
-        bodyBox.SetAsBox(scale.x, scale.y);
-
-        b2FixtureDef fixtureDefinition;
-        fixtureDefinition.shape = &bodyBox;
-        fixtureDefinition.density = 1.0f;
-        fixtureDefinition.friction = 0.3f;
-        rigidbody->SetFixture(fixtureDefinition);
+        scene->_fixtureRebuilds.push_back(entity);
     }
 }
 
 Mango::GUID Mango::Scene::CreateEntity(Mango::ScriptEngine* scriptEngine)
 {
     Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
-    entt::entity entity = scene->AddDefaultEntity(Mango::GeometryType::Rectangle);
+    entt::entity entity = scene->AddDefaultEntity(*scene->FindPrefab("Rectangle"));
     auto& registry = scene->GetRegistry();
     return registry.get<IdComponent>(entity).GetId();
 }
 
-void Mango::Scene::DestroyEntity(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId)
+bool Mango::Scene::InstantiatePrefabByName(Mango::ScriptEngine* scriptEngine, std::string_view prefabName, size_t count, std::vector<Mango::GUID>& entityIds)
 {
     Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
-    auto& registry = scene->GetRegistry();
-
-    entt::entity entity;
-    for (auto [e, id] : registry.view<IdComponent>().each())
+    const auto prefab = scene->FindPrefab(prefabName);
+    if (prefab == nullptr)
     {
-        if (id.GetId() == entityId)
-        {
-            entity = e;
-            break;
-        }
+        return false;
     }
 
-    if (!registry.valid(entity))
+    auto& entities = scene->_instantiatedEntities;
+    entities.clear();
+    scene->InstantiatePrefab(*prefab, count, entities);
+
+    auto& registry = scene->GetRegistry();
+    entityIds.reserve(entityIds.size() + entities.size());
+    for (auto entity : entities)
     {
-        return;
+        entityIds.push_back(registry.get<IdComponent>(entity).GetId());
     }
+    return true;
+}
 
-    Mango::RigidbodyComponent* rigidbody = registry.try_get<RigidbodyComponent>(entity);
-    if (rigidbody != nullptr)
+void Mango::Scene::DestroyEntity(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId)
+{
+    Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
+    auto& registry = scene->GetRegistry();
+    auto entity = scene->GetEntityById(entityId);
+    if (!registry.valid(entity))
     {
-        scene->_physicsWorld.DestroyBody(rigidbody->GetBody());
+        return;
     }
 
-    registry.destroy(entity);
+    scene->_commandBuffer.Destroy(entity);
 }
 
 void Mango::Scene::SetRigid(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, bool isRigid)
@@ -500,15 +875,15 @@ void Mango::Scene::SetRigid(Mango::ScriptEngine* scriptEngine, Mango::GUID entit
     bool shouldRemoveRigidbody = rigidbody != nullptr && isRigid == false;
     if (shouldAddRigidbody)
     {
-        scene->AddRigidbody(entity);
+        scene->_commandBuffer.AddRigidbody(entity);
     }
     if (shouldRemoveRigidbody)
     {
-        registry.remove<RigidbodyComponent>(entity);
+        scene->_commandBuffer.RemoveRigidbody(entity);
     }
 }
 
-void Mango::Scene::ConfigureRigidbody(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, float density, float friction, bool isDynamic)
+void Mango::Scene::ConfigureRigidbody(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, float density, float friction, Mango::RigidbodyType type)
 {
     Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
     auto& registry = scene->GetRegistry();
@@ -518,43 +893,459 @@ void Mango::Scene::ConfigureRigidbody(Mango::ScriptEngine* scriptEngine, Mango::
         return;
     }
 
-    auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
-    if (rigidbody == nullptr)
+    if (!registry.all_of<RigidbodyComponent>(entity))
     {
         return;
     }
 
-    rigidbody->SetDensity(density);
-    rigidbody->SetFriction(friction);
-    rigidbody->SetDynamic(isDynamic);
+    Mango::PhysicsCommand command{ Mango::PhysicsCommandType::SetDensity };
+    command.Entity = entity;
+    command.Value = density;
+    scene->SubmitPhysicsCommand(command);
+    command.Type = Mango::PhysicsCommandType::SetFriction;
+    command.Value = friction;
+    scene->SubmitPhysicsCommand(command);
+    scene->SetRigidbodyType(entity, type);
 }
 
-Mango::GUID Mango::Scene::FindEntityByName(Mango::ScriptEngine* scriptEngine, std::string entityName)
+void Mango::Scene::SetVelocity(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, glm::vec2 velocity)
 {
     Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
     auto& registry = scene->GetRegistry();
-    for (auto [entity, id, name] : registry.view<IdComponent, NameComponent>().each())
+    auto entity = scene->GetEntityById(entityId);
+    if (!registry.valid(entity))
+    {
+        return;
+    }
+
+    if (!registry.all_of<RigidbodyComponent>(entity))
+    {
+        return;
+    }
+
+    Mango::PhysicsCommand command{ Mango::PhysicsCommandType::SetVelocity };
+    command.Entity = entity;
+    command.Vector = velocity;
+    scene->SubmitPhysicsCommand(command);
+}
+
+Mango::GUID Mango::Scene::FindEntityByName(Mango::ScriptEngine* scriptEngine, std::string_view entityName)
+{
+    Mango::Scene* scene = reinterpret_cast<Mango::Scene*>(scriptEngine->GetUserData());
+
+    // If name was never interned, then only an entity with the same default name could have it
+    Mango::StringHandle nameHandle;
+    if (Mango::StringPool::Find(entityName, &nameHandle))
+    {
+        auto it = scene->_entitiesByName.find(nameHandle);
+        if (it != scene->_entitiesByName.end())
+        {
+            return it->second.front();
+        }
+    }
+
+    uint64_t nameKey;
+    if (Mango::NameComponent::FindDefaultNameKey(entityName, &nameKey))
     {
-        std::string wrappedName = std::string(name.GetName());
-        if (wrappedName == entityName)
+        auto it = scene->_entitiesByName.find(nameKey);
+        if (it != scene->_entitiesByName.end())
         {
-            return id.GetId();
+            return it->second.front();
         }
     }
     return Mango::GUID::Empty();
 }
 
-entt::entity Mango::Scene::AddDefaultEntity(Mango::GeometryType geometry)
+entt::entity Mango::Scene::AddDefaultEntity(const Mango::Prefab& prefab)
 {
-    const auto entity = _registry.create();
-    _registry.emplace<IdComponent>(entity);
-    _registry.emplace<NameComponent>(entity);
-    _registry.emplace<TransformComponent>(entity, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
-    _registry.emplace<ColorComponent>(entity, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    _registry.emplace<GeometryComponent>(entity, geometry);
+    _instantiatedEntities.clear();
+    InstantiatePrefab(prefab, 1, _instantiatedEntities);
+
+    // Entities added from editor and by CreateEntity keep their numbered "Entity N" names
+    const auto entity = _instantiatedEntities.front();
+    _registry.replace<NameComponent>(entity);
     return entity;
 }
 
+void Mango::Scene::ClearEntities()
+{
+    // All bodies are destroyed below, so queued physics changes are dropped
+    _physicsThread.Wait();
+    _physicsCommands.clear();
+    _physicsThread.ClearBodies();
+    _fixtureRebuilds.clear();
+    _kinematicTargets.clear();
+    _drivenBodies.clear();
+
+    // Whole hierarchy goes away, so links aren't unlinked node by node
+    _registry.on_destroy<RelationshipComponent>().disconnect<&Mango::Scene::OnRelationshipComponentDestroy>(*this);
+    _registry.clear();
+    _registry.on_destroy<RelationshipComponent>().connect<&Mango::Scene::OnRelationshipComponentDestroy>(*this);
+
+    // Bodies of entities created during play are destroyed as well
+    b2Body* body = _physicsWorld.GetBodyList();
+    while (body != nullptr)
+    {
+        b2Body* nextBody = body->GetNext();
+        _physicsWorld.DestroyBody(body);
+        body = nextBody;
+    }
+    _collisionListener->ClearEvents();
+
+    _commandBuffer.Clear();
+    _destroyedEntityIds.clear();
+    _dirtyHierarchyRoots.clear();
+    _dirtyTransforms.clear();
+    _renderablesOrderDirty = true;
+    _entitiesById.clear();
+    _entitiesByName.clear();
+    _indexedNames.clear();
+}
+
+void Mango::Scene::PlaybackCommands()
+{
+    if (_commandBuffer.IsEmpty())
+    {
+        return;
+    }
+
+    for (const auto& command : _commandBuffer.GetCommands())
+    {
+        if (!_registry.valid(command.Entity))
+        {
+            continue;
+        }
+
+        switch (command.Type)
+        {
+        case Mango::EntityCommandType::AddRigidbody:
+            AddRigidbody(command.Entity);
+            break;
+        case Mango::EntityCommandType::RemoveRigidbody:
+            RemoveRigidbody(command.Entity);
+            break;
+        }
+    }
+
+    // Destroys are sorted and deduplicated, so every entity is torn down exactly once
+    auto& destroyedEntities = _commandBuffer.SortDestroyedEntities();
+    std::erase_if(destroyedEntities, [this](entt::entity entity) { return !_registry.valid(entity); });
+    _destroyedEntityIds.clear();
+    for (auto entity : destroyedEntities)
+    {
+        auto [id, rigidbody] = _registry.try_get<IdComponent, RigidbodyComponent>(entity);
+        if (rigidbody != nullptr && rigidbody->GetBody() != nullptr)
+        {
+            Mango::PhysicsCommand command{ Mango::PhysicsCommandType::DestroyBody };
+            command.Body = rigidbody->GetBody();
+            SubmitPhysicsCommand(command);
+        }
+        if (id != nullptr)
+        {
+            _destroyedEntityIds.push_back(id->GetId());
+        }
+    }
+
+    _scriptEngine->OnEntitiesDestroyed(_destroyedEntityIds);
+    _registry.destroy(destroyedEntities.begin(), destroyedEntities.end());
+
+    _commandBuffer.Clear();
+}
+
+void Mango::Scene::SyncPhysics()
+{
+    if (!_physicsThread.IsStepping())
+    {
+        return;
+    }
+    _physicsThread.Wait();
+
+    // Only bodies that moved during the step have poses, so transforms of sleeping bodies stay clean.
+    // Poses are looked up by id of their entity, lookups and component writes don't change registry
+    const auto& poses = _physicsThread.GetPoses();
+    auto& transforms = _registry.storage<TransformComponent>();
+    auto& rigidbodies = _registry.storage<RigidbodyComponent>();
+    _syncedEntities.resize(poses.size());
+    Mango::JobSystem::ParallelFor(poses.size(), _transformsGrainSize, [this, &poses, &rigidbodies](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const auto& pose = poses[i];
+            auto entity = GetEntityById(pose.EntityId);
+            // Body could be removed from its entity while it was stepped
+            if (entity != entt::null && (!rigidbodies.contains(entity) || rigidbodies.get(entity).GetBody() != pose.Body))
+            {
+                entity = entt::null;
+            }
+            _syncedEntities[i] = entity;
+            if (entity == entt::null)
+            {
+                continue;
+            }
+
+            // Sleeping body stays where it is, so it's no longer interpolated
+            auto& rigidbody = rigidbodies.get(entity);
+            if (pose.IsAsleep)
+            {
+                rigidbody.SetPose(pose.Position, pose.Angle);
+            }
+            else
+            {
+                rigidbody.SetSimulatedPose(pose.Position, pose.Angle);
+            }
+        }
+    });
+
+    // Transform setters add entities to the dirty transforms list, so they are called from this thread only
+    for (size_t i = 0; i < poses.size(); i++)
+    {
+        const auto entity = _syncedEntities[i];
+        if (entity == entt::null || !transforms.contains(entity))
+        {
+            continue;
+        }
+
+        const auto& pose = poses[i];
+        auto& transform = transforms.get(entity);
+        const auto translation = transform.GetTranslation();
+        transform.SetTranslation(glm::vec3(pose.Position, translation.z));
+        const auto rotation = transform.GetRotation();
+        transform.SetRotation(glm::vec3(rotation.x, rotation.y, glm::degrees(pose.Angle)));
+    }
+
+    // Changes queued while world was stepped override simulated poses
+    for (const auto& command : _physicsCommands)
+    {
+        ApplyPhysicsCommand(command);
+    }
+    _physicsCommands.clear();
+}
+
+void Mango::Scene::SubmitPhysicsCommand(const Mango::PhysicsCommand& command)
+{
+    if (_physicsThread.IsStepping())
+    {
+        _physicsCommands.push_back(command);
+        return;
+    }
+
+    ApplyPhysicsCommand(command);
+}
+
+void Mango::Scene::ApplyPhysicsCommand(const Mango::PhysicsCommand& command)
+{
+    if (command.Type == Mango::PhysicsCommandType::DestroyBody)
+    {
+        _physicsThread.OnBodyDestroyed(command.Body);
+        _physicsWorld.DestroyBody(command.Body);
+        return;
+    }
+
+    // Entity could be destroyed or lose its rigidbody after command was queued
+    if (!_registry.valid(command.Entity))
+    {
+        return;
+    }
+    auto rigidbody = _registry.try_get<RigidbodyComponent>(command.Entity);
+    if (rigidbody == nullptr)
+    {
+        return;
+    }
+
+    if (command.Type == Mango::PhysicsCommandType::CreateBody)
+    {
+        if (rigidbody->GetBody() != nullptr)
+        {
+            return;
+        }
+
+        // Store GUID by value, pointers into component storage are invalidated when the storage grows
+        const auto& id = _registry.get<IdComponent>(command.Entity).GetId();
+        b2BodyDef bodyDefinition;
+        bodyDefinition.userData.pointer = static_cast<uintptr_t>(static_cast<uint64_t>(id));
+        rigidbody->AttachBody(_physicsWorld.CreateBody(&bodyDefinition));
+
+        auto& transform = _registry.get<TransformComponent>(command.Entity);
+        auto translation = transform.GetTranslation();
+        auto rotation = transform.GetRotation().z;
+        rigidbody->SetTransform(glm::vec2(translation.x, translation.y), glm::radians(rotation));
+        RebuildFixture(command.Entity, *rigidbody);
+        return;
+    }
+
+    // Body settings are kept by component, so they are applied even if its body isn't created yet
+    switch (command.Type)
+    {
+    case Mango::PhysicsCommandType::SetType:
+        rigidbody->SetType(command.BodyType);
+        return;
+    case Mango::PhysicsCommandType::SetDensity:
+        rigidbody->SetDensity(command.Value);
+        return;
+    case Mango::PhysicsCommandType::SetFriction:
+        rigidbody->SetFriction(command.Value);
+        return;
+    default:
+        break;
+    }
+
+    if (rigidbody->GetBody() == nullptr)
+    {
+        return;
+    }
+
+    switch (command.Type)
+    {
+    case Mango::PhysicsCommandType::ApplyForce:
+        rigidbody->ApplyForce(command.Vector);
+        break;
+    case Mango::PhysicsCommandType::SetVelocity:
+        rigidbody->SetVelocity(command.Vector);
+        break;
+    case Mango::PhysicsCommandType::SetTransform:
+    {
+        rigidbody->SetTransform(command.Vector, command.Value);
+        // Simulated pose was written into transform after teleport was requested
+        auto& transform = _registry.get<TransformComponent>(command.Entity);
+        const auto translation = transform.GetTranslation();
+        transform.SetTranslation(glm::vec3(command.Vector, translation.z));
+        const auto rotation = transform.GetRotation();
+        transform.SetRotation(glm::vec3(rotation.x, rotation.y, glm::degrees(command.Value)));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void Mango::Scene::RebuildFixture(entt::entity entity, Mango::RigidbodyComponent& rigidbody)
+{
+    // Entities without geometry collide as rectangles
+    auto geometry = _registry.try_get<GeometryComponent>(entity);
+    const auto geometryType = geometry != nullptr ? geometry->GetGeometry() : Mango::GeometryType::Rectangle;
+    const auto scale = _registry.get<TransformComponent>(entity).GetScale();
+    rigidbody.SetShape(_shapeCache.GetShape(geometryType, glm::vec2(scale)));
+}
+
+void Mango::Scene::RebuildFixtures()
+{
+    if (_fixtureRebuilds.empty())
+    {
+        return;
+    }
+
+    std::sort(_fixtureRebuilds.begin(), _fixtureRebuilds.end());
+    _fixtureRebuilds.erase(std::unique(_fixtureRebuilds.begin(), _fixtureRebuilds.end()), _fixtureRebuilds.end());
+    for (auto entity : _fixtureRebuilds)
+    {
+        if (!_registry.valid(entity))
+        {
+            continue;
+        }
+
+        // Body created since rebuild was requested already got fixture of current scale
+        auto rigidbody = _registry.try_get<RigidbodyComponent>(entity);
+        if (rigidbody != nullptr && rigidbody->GetBody() != nullptr)
+        {
+            RebuildFixture(entity, *rigidbody);
+        }
+    }
+    _fixtureRebuilds.clear();
+}
+
+void Mango::Scene::DriveKinematicBodies()
+{
+    // Bodies without a new target stop, so a mover stays where its script left it
+    for (auto entity : _drivenBodies)
+    {
+        auto rigidbody = _registry.valid(entity) ? _registry.try_get<RigidbodyComponent>(entity) : nullptr;
+        if (rigidbody != nullptr && rigidbody->GetBody() != nullptr)
+        {
+            rigidbody->StopDriving();
+        }
+    }
+    _drivenBodies.clear();
+
+    // Target is consumed by the first drive, so repeated entries are skipped
+    for (auto entity : _kinematicTargets)
+    {
+        auto rigidbody = _registry.valid(entity) ? _registry.try_get<RigidbodyComponent>(entity) : nullptr;
+        if (rigidbody == nullptr || rigidbody->GetBody() == nullptr || !rigidbody->HasTarget())
+        {
+            continue;
+        }
+
+        rigidbody->DriveToTarget(_timeStep);
+        _drivenBodies.push_back(entity);
+    }
+    _kinematicTargets.clear();
+}
+
+void Mango::Scene::DeliverCollisionEvents()
+{
+    // Most contacts are between entities without collision handlers, they are dropped before any lookup.
+    // Bodies could outlive their entities until their destruction is applied
+    auto& events = _collisionListener->GetEvents();
+    std::erase_if(events, [this](const Mango::CollisionEvent& event)
+    {
+        if (!_scriptEngine->HandlesCollisions(event.FirstId) && !_scriptEngine->HandlesCollisions(event.SecondId))
+        {
+            return true;
+        }
+        return GetEntityById(event.FirstId) == entt::null || GetEntityById(event.SecondId) == entt::null;
+    });
+
+    _scriptEngine->OnCollisions(events);
+    _collisionListener->ClearEvents();
+}
+
+void Mango::Scene::PartitionRenderables()
+{
+    // Group members join at its end and leave by swapping with its last member,
+    // so only the few triangles and rectangles that ended up on the wrong side of the split are swapped
+    auto renderables = _registry.group<TransformComponent, ColorComponent, GeometryComponent>();
+    const auto entities = renderables.begin();
+    const auto isTriangle = [&renderables](entt::entity entity) { return renderables.get<GeometryComponent>(entity).GetGeometry() == Mango::GeometryType::Triangle; };
+
+    size_t first = 0;
+    size_t last = renderables.size();
+    while (true)
+    {
+        while (first < last && isTriangle(entities[first]))
+        {
+            first++;
+        }
+        while (first < last && !isTriangle(entities[last - 1]))
+        {
+            last--;
+        }
+        if (first == last)
+        {
+            break;
+        }
+
+        // Owned storages are swapped together, so group stays aligned
+        const entt::entity rectangle = entities[first];
+        const entt::entity triangle = entities[last - 1];
+        _registry.storage<TransformComponent>().swap_elements(rectangle, triangle);
+        _registry.storage<ColorComponent>().swap_elements(rectangle, triangle);
+        _registry.storage<GeometryComponent>().swap_elements(rectangle, triangle);
+    }
+    _trianglesCount = first;
+}
+
+glm::mat4 Mango::Scene::InterpolateBodyTransform(Mango::TransformComponent& transform, Mango::RigidbodyComponent& rigidbody, float alpha)
+{
+    // Bodies only move in XY plane and rotate around Z, the rest of transform is taken as is
+    const glm::vec2 position = glm::mix(rigidbody.GetPreviousPosition(), rigidbody.GetPosition(), alpha);
+    const float angle = glm::mix(rigidbody.GetPreviousAngle(), rigidbody.GetAngle(), alpha);
+    const glm::vec3 rotation = transform.GetRotation();
+    const glm::quat quaternionRotation({ glm::radians(rotation.x), glm::radians(rotation.y), angle });
+    return glm::translate(glm::mat4(1.0f), glm::vec3(position, transform.GetTranslation().z))
+        * glm::toMat4(quaternionRotation)
+        * glm::scale(glm::mat4(1.0f), transform.GetScale());
+}
+
 void Mango::Scene::SetRendererCamera(Mango::CameraComponent& camera, Mango::TransformComponent& transform)
 {
     RendererCameraInfo cameraInfo{};
@@ -566,36 +1357,290 @@ void Mango::Scene::SetRendererCamera(Mango::CameraComponent& camera, Mango::Tran
     _renderer.SetCamera(cameraInfo);
 }
 
-entt::entity Mango::Scene::GetEntityById(Mango::GUID entityId)
+void Mango::Scene::UpdateTransforms()
 {
-    for (auto [entity, id] : _registry.view<IdComponent>().each())
+    _transformStore.Clear();
+    _composedTransforms.clear();
+    _composedEntities.clear();
+
+    // Static transforms are never visited, only the ones changed since the last frame are listed
+    auto& transforms = _registry.storage<TransformComponent>();
+    for (auto entity : _dirtyTransforms)
+    {
+        // Entity could be destroyed after its transform changed
+        if (!_registry.valid(entity) || !transforms.contains(entity))
+        {
+            continue;
+        }
+
+        // Matrix could be already composed on demand by GetTransform
+        auto& transform = transforms.get(entity);
+        transform.TakeOffDirtyList();
+        if (!transform.IsDirty())
+        {
+            continue;
+        }
+
+        _transformStore.Add(transform.GetTranslation(), transform.GetRotation(), transform.GetScale());
+        _composedTransforms.push_back(&transform);
+        _composedEntities.push_back(entity);
+    }
+    _dirtyTransforms.clear();
+
+    if (!_composedTransforms.empty())
     {
-        if (id.GetId() == entityId)
+        _transformStore.Compose();
+        Mango::JobSystem::ParallelFor(_composedTransforms.size(), _transformsGrainSize, [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                _composedTransforms[i]->SetComposedTransform(_transformStore.GetTransform(i));
+            }
+        });
+
+        // Changed hierarchy nodes must pass their new transform down to their children
+        for (auto entity : _composedEntities)
         {
-            return entity;
+            if (_registry.all_of<RelationshipComponent>(entity))
+            {
+                _dirtyHierarchyRoots.push_back(entity);
+            }
         }
     }
-    return entt::entity();
+
+    PropagateTransforms();
 }
 
-void Mango::CollisionListener::BeginContact(b2Contact* contact)
+void Mango::Scene::PropagateTransforms()
 {
-    b2BodyUserData userData = contact->GetFixtureA()->GetBody()->GetUserData();
-    Mango::GUID* firstId = reinterpret_cast<Mango::GUID*>(userData.pointer);
+    if (_dirtyHierarchyRoots.empty())
+    {
+        return;
+    }
 
-    userData = contact->GetFixtureB()->GetBody()->GetUserData();
-    Mango::GUID* secondId = reinterpret_cast<Mango::GUID*>(userData.pointer);
+    // Nodes could be destroyed after they were marked as dirty
+    std::erase_if(_dirtyHierarchyRoots, [this](entt::entity entity) { return !_registry.valid(entity) || !_registry.all_of<RelationshipComponent, TransformComponent>(entity); });
+
+    // Start from the shallowest nodes, so every changed subtree is walked only once
+    std::sort(_dirtyHierarchyRoots.begin(), _dirtyHierarchyRoots.end(), [this](entt::entity lhs, entt::entity rhs)
+    {
+        return _registry.get<RelationshipComponent>(lhs).GetDepth() < _registry.get<RelationshipComponent>(rhs).GetDepth();
+    });
 
-    _scriptEngine->OnCollisionBegin(*firstId, *secondId);
+    _propagationStamp++;
+    for (auto root : _dirtyHierarchyRoots)
+    {
+        if (_registry.get<RelationshipComponent>(root).GetPropagationStamp() == _propagationStamp)
+        {
+            continue;
+        }
+
+        _propagationStack.push_back(root);
+        while (!_propagationStack.empty())
+        {
+            const auto entity = _propagationStack.back();
+            _propagationStack.pop_back();
+
+            auto [relationship, transform] = _registry.get<RelationshipComponent, TransformComponent>(entity);
+            relationship.SetPropagationStamp(_propagationStamp);
+
+            const auto parent = relationship.GetParent();
+            if (parent != entt::null)
+            {
+                transform.SetWorldTransform(_registry.get<TransformComponent>(parent).GetWorldTransform() * transform.GetTransform());
+            }
+
+            for (auto child = relationship.GetFirstChild(); child != entt::null; child = _registry.get<RelationshipComponent>(child).GetNextSibling())
+            {
+                _propagationStack.push_back(child);
+            }
+        }
+    }
+    _dirtyHierarchyRoots.clear();
 }
 
-void Mango::CollisionListener::EndContact(b2Contact* contact)
+void Mango::Scene::UnlinkFromParent(entt::entity entity, Mango::RelationshipComponent& relationship)
+{
+    const auto parent = relationship.GetParent();
+    if (parent == entt::null)
+    {
+        return;
+    }
+
+    auto& parentRelationship = _registry.get<RelationshipComponent>(parent);
+    const auto previousSibling = relationship.GetPreviousSibling();
+    const auto nextSibling = relationship.GetNextSibling();
+    if (previousSibling != entt::null)
+    {
+        _registry.get<RelationshipComponent>(previousSibling).SetNextSibling(nextSibling);
+    }
+    else
+    {
+        parentRelationship.SetFirstChild(nextSibling);
+    }
+    if (nextSibling != entt::null)
+    {
+        _registry.get<RelationshipComponent>(nextSibling).SetPreviousSibling(previousSibling);
+    }
+    parentRelationship.SetChildrenCount(parentRelationship.GetChildrenCount() - 1);
+
+    relationship.SetParent(entt::null);
+    relationship.SetPreviousSibling(entt::null);
+    relationship.SetNextSibling(entt::null);
+}
+
+void Mango::Scene::UpdateSubtreeDepth(entt::entity root, uint32_t depth)
+{
+    std::vector<std::pair<entt::entity, uint32_t>> stack{ { root, depth } };
+    while (!stack.empty())
+    {
+        const auto [entity, entityDepth] = stack.back();
+        stack.pop_back();
+
+        auto& relationship = _registry.get<RelationshipComponent>(entity);
+        relationship.SetDepth(entityDepth);
+        for (auto child = relationship.GetFirstChild(); child != entt::null; child = _registry.get<RelationshipComponent>(child).GetNextSibling())
+        {
+            stack.emplace_back(child, entityDepth + 1);
+        }
+    }
+}
+
+entt::entity Mango::Scene::GetEntityById(Mango::GUID entityId)
+{
+    auto it = _entitiesById.find(entityId);
+    if (it == _entitiesById.end())
+    {
+        return entt::null;
+    }
+    return it->second;
+}
+
+void Mango::Scene::OnIdComponentConstruct(entt::registry& registry, entt::entity entity)
+{
+    const auto& id = registry.get<IdComponent>(entity).GetId();
+    _entitiesById[id] = entity;
+}
+
+void Mango::Scene::OnIdComponentUpdate(entt::registry& registry, entt::entity entity)
+{
+    // Previous id isn't known anymore, ids are rarely changed so index is searched for the entity
+    std::erase_if(_entitiesById, [entity](const auto& indexed) { return indexed.second == entity; });
+    OnIdComponentConstruct(registry, entity);
+
+    // Names are indexed by ids, so the name entry has to move to the new id
+    if (registry.all_of<NameComponent>(entity))
+    {
+        OnNameComponentUpdate(registry, entity);
+    }
+}
+
+void Mango::Scene::OnIdComponentDestroy(entt::registry& registry, entt::entity entity)
+{
+    const auto& id = registry.get<IdComponent>(entity).GetId();
+    auto it = _entitiesById.find(id);
+    // Entity could be already replaced by another entity with the same id
+    if (it != _entitiesById.end() && it->second == entity)
+    {
+        _entitiesById.erase(it);
+    }
+}
+
+void Mango::Scene::OnNameComponentConstruct(entt::registry& registry, entt::entity entity)
 {
-    b2BodyUserData userData = contact->GetFixtureA()->GetBody()->GetUserData();
-    Mango::GUID* firstId = reinterpret_cast<Mango::GUID*>(userData.pointer);
+    const auto id = registry.try_get<IdComponent>(entity);
+    if (id == nullptr)
+    {
+        return;
+    }
+
+    const auto nameKey = registry.get<NameComponent>(entity).GetNameKey();
+    _entitiesByName[nameKey].push_back(id->GetId());
+    _indexedNames[entity] = std::make_pair(nameKey, id->GetId());
+}
 
-    userData = contact->GetFixtureB()->GetBody()->GetUserData();
-    Mango::GUID* secondId = reinterpret_cast<Mango::GUID*>(userData.pointer);
+void Mango::Scene::OnNameComponentUpdate(entt::registry& registry, entt::entity entity)
+{
+    OnNameComponentDestroy(registry, entity);
+    OnNameComponentConstruct(registry, entity);
+}
 
-    _scriptEngine->OnCollisionEnd(*firstId, *secondId);
+void Mango::Scene::OnNameComponentDestroy(entt::registry& registry, entt::entity entity)
+{
+    // IdComponent could be already removed here, so GUID is taken from the index itself
+    auto indexed = _indexedNames.find(entity);
+    if (indexed == _indexedNames.end())
+    {
+        return;
+    }
+
+    const auto [nameKey, id] = indexed->second;
+    _indexedNames.erase(indexed);
+
+    auto& ids = _entitiesByName[nameKey];
+    ids.erase(std::find(ids.begin(), ids.end(), id));
+    if (ids.empty())
+    {
+        _entitiesByName.erase(nameKey);
+    }
+}
+
+void Mango::Scene::OnRelationshipComponentDestroy(entt::registry& registry, entt::entity entity)
+{
+    auto& relationship = registry.get<RelationshipComponent>(entity);
+    UnlinkFromParent(entity, relationship);
+
+    // Children are not destroyed with their parent, they become roots of their own hierarchies
+    auto child = relationship.GetFirstChild();
+    while (child != entt::null)
+    {
+        auto& childRelationship = registry.get<RelationshipComponent>(child);
+        const auto nextSibling = childRelationship.GetNextSibling();
+        childRelationship.SetParent(entt::null);
+        childRelationship.SetPreviousSibling(entt::null);
+        childRelationship.SetNextSibling(entt::null);
+
+        auto childTransform = registry.try_get<TransformComponent>(child);
+        if (childTransform != nullptr)
+        {
+            childTransform->SetHasParent(false);
+        }
+
+        UpdateSubtreeDepth(child, 0);
+        _dirtyHierarchyRoots.push_back(child);
+        child = nextSibling;
+    }
+    relationship.SetFirstChild(entt::null);
+    relationship.SetChildrenCount(0);
+}
+
+void Mango::Scene::OnTransformComponentConstruct(entt::registry& registry, entt::entity entity)
+{
+    // Transform copied from another scene still refers to the list of that scene
+    registry.get<TransformComponent>(entity).AttachDirtyList(&_dirtyTransforms, entity);
+}
+
+void Mango::Scene::OnRenderableChanged(entt::registry& registry, entt::entity entity)
+{
+    // Entity joins or leaves the group only when it has every renderable component.
+    // Rectangles join at the end and leave by swapping with another rectangle, so they never break the split
+    if (registry.all_of<TransformComponent, ColorComponent, GeometryComponent>(entity)
+        && registry.get<GeometryComponent>(entity).GetGeometry() == Mango::GeometryType::Triangle)
+    {
+        _renderablesOrderDirty = true;
+    }
+}
+
+void Mango::CollisionListener::BeginContact(b2Contact* contact)
+{
+    Mango::GUID firstId(contact->GetFixtureA()->GetBody()->GetUserData().pointer);
+    Mango::GUID secondId(contact->GetFixtureB()->GetBody()->GetUserData().pointer);
+    _events.push_back({ true, firstId, secondId });
+}
+
+void Mango::CollisionListener::EndContact(b2Contact* contact)
+{
+    Mango::GUID firstId(contact->GetFixtureA()->GetBody()->GetUserData().pointer);
+    Mango::GUID secondId(contact->GetFixtureB()->GetBody()->GetUserData().pointer);
+    _events.push_back({ false, firstId, secondId });
 }
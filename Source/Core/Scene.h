@@ -1,6 +1,13 @@
 #pragma once
 
 #include "GUID.h"
+#include "CollisionEvent.h"
+#include "TransformStore.h"
+#include "Prefab.h"
+#include "EntityCommandBuffer.h"
+#include "PhysicsThread.h"
+#include "ShapeCache.h"
+#include "WorldStreamer.h"
 #include "Components/Components.h"
 #include "../Render/Renderer.h"
 #include "Scripting/ScriptEngine.h"
@@ -9,20 +16,30 @@
 #include <entt/entity/registry.hpp>
 #include <box2d/box2d.h>
 
+#include <filesystem>
 #include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace Mango
 {
+	class Scene;
+
+	// Contacts are reported on physics thread while world is stepped, so they are only collected here.
+	// Scene delivers them to scripts once the step is completed
 	class CollisionListener : public b2ContactListener
 	{
 	public:
-		CollisionListener(Mango::ScriptEngine* scriptEngine) { _scriptEngine = scriptEngine; }
-
 		virtual void BeginContact(b2Contact* contact);
 		virtual void EndContact(b2Contact* contact);
 
+		// Flat array of contacts reported during the last step
+		inline std::vector<Mango::CollisionEvent>& GetEvents() { return _events; }
+		void ClearEvents() { _events.clear(); }
+
 	private:
-		Mango::ScriptEngine* _scriptEngine;
+		std::vector<Mango::CollisionEvent> _events;
 	};
 
 	enum SceneState
@@ -41,14 +58,20 @@ namespace Mango
 
 		entt::registry& GetRegistry() { return _registry; }
 
+		// Script engine owns process wide Python interpreter, so only the active scene has one.
+		// Scene could be built on any thread, but script engine is created and destroyed on main thread only
+		void CreateScriptEngine();
+		void DestroyScriptEngine();
+
 		// Happens when scene was loaded
 		void OnCreate();
 
-		// Happens every frame
-		void OnUpdate();
+		// Happens every frame. Interpolation alpha is the fraction of fixed step accumulated since the last fixed update
+		void OnUpdate(float deltaTime, float interpolationAlpha);
 
-		// Happens 60 times per frame
+		// Happens every fixed time step, possibly several times per frame
 		void OnFixedUpdate();
+		inline float GetFixedDeltaTime() const { return _timeStep; }
 
 		// Start game view of this scene
 		void OnPlay();
@@ -67,12 +90,38 @@ namespace Mango
 		// Add new camera to scene
 		entt::entity AddCamera();
 
+		// Physics bodies are created and destroyed at the next physics sync point if world is being stepped
 		void AddRigidbody(entt::entity entity);
+		void RemoveRigidbody(entt::entity entity);
+		void SetRigidbodyType(entt::entity entity, Mango::RigidbodyType type);
 		void AddScript(entt::entity entity);
 
-		// Delete specified entity from scene
+		// Delete specified entity from scene. Entity is destroyed at the next sync point
 		void DeleteEntity(entt::entity entity);
 
+		// Rename entity and update names index
+		void SetEntityName(entt::entity entity, std::string_view name);
+
+		// Add prefab definition to scene, existing prefab with the same name is replaced
+		void RegisterPrefab(const Mango::Prefab& prefab);
+		// Returns nullptr if there is no prefab with specified name
+		const Mango::Prefab* FindPrefab(std::string_view name);
+		inline const std::unordered_map<Mango::StringHandle, Mango::Prefab>& GetPrefabs() const { return _prefabs; }
+
+		// Create count instances of prefab at once, new entities are appended to entities
+		void InstantiatePrefab(const Mango::Prefab& prefab, size_t count, std::vector<entt::entity>& entities);
+
+		// Attach entity to parent, entt::null detaches entity from its current parent.
+		// Returns false if entity is the parent itself or one of its ancestors
+		bool SetEntityParent(entt::entity entity, entt::entity parent);
+
+		// Stream chunks of world described by manifest around scene camera, replaces currently streamed world
+		void OpenWorld(const std::filesystem::path& manifestPath);
+		// Stop streaming, entities of loaded chunks are removed from scene
+		void CloseWorld();
+		// Returns nullptr if scene doesn't stream any world
+		inline Mango::WorldStreamer* GetWorldStreamer() { return _worldStreamer.get(); }
+
 	private:
 		// Manipualte scene entities methods
 		static void ApplyForce(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, glm::vec2 force);
@@ -88,8 +137,14 @@ namespace Mango
 		static Mango::GUID CreateEntity(Mango::ScriptEngine* scriptEngine);
 		static void DestroyEntity(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId);
 		static void SetRigid(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, bool isRigid);
-		static void ConfigureRigidbody(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, float density, float friction, bool isDynamic);
-		static Mango::GUID FindEntityByName(Mango::ScriptEngine* scriptEngine, std::string entityName);
+		static void ConfigureRigidbody(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, float density, float friction, Mango::RigidbodyType type);
+		static void SetVelocity(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, glm::vec2 velocity);
+		static Mango::GUID FindEntityByName(Mango::ScriptEngine* scriptEngine, std::string_view entityName);
+		static void SetParent(Mango::ScriptEngine* scriptEngine, Mango::GUID entityId, Mango::GUID parentId);
+		static float GetDeltaTime(Mango::ScriptEngine* scriptEngine);
+		static float GetFixedDeltaTime(Mango::ScriptEngine* scriptEngine);
+		static float GetInterpolationAlpha(Mango::ScriptEngine* scriptEngine);
+		static bool InstantiatePrefabByName(Mango::ScriptEngine* scriptEngine, std::string_view prefabName, size_t count, std::vector<Mango::GUID>& entityIds);
 
 	private:
 		Mango::Renderer& _renderer;
@@ -101,16 +156,123 @@ namespace Mango
 		const int32_t _velocityIterations = 8;
 		const int32_t _positionIterations = 3;
 		b2World _physicsWorld{{ 0.0f, -9.8f }};
-		std::unique_ptr<b2ContactListener> _collisionListener;
+		std::unique_ptr<Mango::CollisionListener> _collisionListener;
+		// World is stepped between fixed updates while the frame is rendered, changes made meanwhile are queued
+		Mango::PhysicsThread _physicsThread{ _physicsWorld, _timeStep, _velocityIterations, _positionIterations };
+		std::vector<Mango::PhysicsCommand> _physicsCommands;
+		// Fixtures of bodies whose scale changed are rebuilt right before the next step
+		Mango::ShapeCache _shapeCache;
+		std::vector<entt::entity> _fixtureRebuilds;
+		// Kinematic bodies that got a target since the last step and bodies driven by the last step
+		std::vector<entt::entity> _kinematicTargets;
+		std::vector<entt::entity> _drivenBodies;
+
+		// Frame timing, scripts get fixed time step as delta time during fixed update
+		float _deltaTime = 0.0f;
+		float _interpolationAlpha = 0.0f;
+		bool _isFixedUpdating = false;
+
+		// Renderables group is partitioned by geometry, so instances of every geometry take a contiguous range of slots
+		size_t _trianglesCount = 0;
+		bool _renderablesOrderDirty = true;
+		Mango::DrawList _drawList;
+		static constexpr size_t _extractionGrainSize = 8192;
+
+		// Entity and versions of its components each instance slot was last sent with
+		struct InstanceVersion
+		{
+			entt::entity Entity = entt::null;
+			uint32_t Transform = 0;
+			uint32_t Color = 0;
+			// Interpolated pose isn't described by versions, slot is resent once body stops being interpolated
+			bool Interpolated = false;
+		};
+		std::vector<InstanceVersion> _instanceVersions;
+		std::vector<std::vector<uint32_t>> _changedSlotsPerChunk;
+
+		// Structural changes requested by scripts and editor
+		Mango::EntityCommandBuffer _commandBuffer;
+		std::vector<Mango::GUID> _destroyedEntityIds;
 
 		// Scripting
 		std::unique_ptr<Mango::ScriptEngine> _scriptEngine;
+		// Script file name to its path, collected when scene starts playing
+		std::unordered_map<std::string, std::filesystem::path> _scriptPaths;
+
+		// Prefabs by interned name
+		std::unordered_map<Mango::StringHandle, Mango::Prefab> _prefabs;
+		std::vector<entt::entity> _instantiatedEntities;
+
+		// Batched composition of changed transforms
+		static constexpr size_t _transformsGrainSize = 2048;
+		Mango::TransformStore _transformStore;
+		std::vector<Mango::TransformComponent*> _composedTransforms;
+		std::vector<entt::entity> _composedEntities;
+		// Entities whose transform changed since the last composition, filled by transform setters
+		std::vector<entt::entity> _dirtyTransforms;
+		// Entities of poses written back after physics step
+		std::vector<entt::entity> _syncedEntities;
+
+		// Hierarchy
+		std::vector<entt::entity> _dirtyHierarchyRoots;
+		std::vector<entt::entity> _propagationStack;
+		uint32_t _propagationStamp = 0;
+
+		// GUID to entity index, kept in sync with IdComponent storage through registry signals
+		std::unordered_map<Mango::GUID, entt::entity> _entitiesById;
+
+		// Name key to GUIDs index, GUIDs are kept in order their entities got the name. See NameComponent::GetNameKey
+		std::unordered_map<uint64_t, std::vector<Mango::GUID>> _entitiesByName;
+		std::unordered_map<entt::entity, std::pair<uint64_t, Mango::GUID>> _indexedNames;
+
+		// Streamed world chunks
+		std::unique_ptr<Mango::WorldStreamer> _worldStreamer;
 
 	private:
-		entt::entity AddDefaultEntity(Mango::GeometryType geometry);
+		entt::entity AddDefaultEntity(const Mango::Prefab& prefab);
+		// Destroy all entities and physics bodies at once and reset everything derived from them
+		void ClearEntities();
+		// Sync point: apply all recorded structural changes
+		void PlaybackCommands();
+		// Physics sync point: wait for stepped world, copy its poses into entities and apply queued changes
+		void SyncPhysics();
+		// Applied right away when physics world isn't stepped, otherwise queued until the next sync point
+		void SubmitPhysicsCommand(const Mango::PhysicsCommand& command);
+		void ApplyPhysicsCommand(const Mango::PhysicsCommand& command);
+		// Contacts are handed over to scripts in one batch, contacts no script handles are dropped
+		void DeliverCollisionEvents();
+		// Replace fixture of body with cached shape of entity geometry and scale
+		void RebuildFixture(entt::entity entity, Mango::RigidbodyComponent& rigidbody);
+		void RebuildFixtures();
+		// Set velocities that move kinematic bodies to their targets during the next step
+		void DriveKinematicBodies();
+		// Move triangles in front of rectangles and count them
+		void PartitionRenderables();
+		// Transform of physics body between its pose before the last step and the current one
+		static glm::mat4 InterpolateBodyTransform(Mango::TransformComponent& transform, Mango::RigidbodyComponent& rigidbody, float alpha);
 		void SetRendererCamera(Mango::CameraComponent& camera, Mango::TransformComponent& transform);
+		// Recompose all changed transform matrices in SIMD batches
+		void UpdateTransforms();
+		// Propagate world transforms through subtrees of changed hierarchy nodes
+		void PropagateTransforms();
+		void UnlinkFromParent(entt::entity entity, Mango::RelationshipComponent& relationship);
+		void UpdateSubtreeDepth(entt::entity root, uint32_t depth);
+		// Returns entt::null if there is no entity with specified id
 		entt::entity GetEntityById(Mango::GUID entityId);
 
+		void OnIdComponentConstruct(entt::registry& registry, entt::entity entity);
+		void OnIdComponentUpdate(entt::registry& registry, entt::entity entity);
+		void OnIdComponentDestroy(entt::registry& registry, entt::entity entity);
+		void OnNameComponentConstruct(entt::registry& registry, entt::entity entity);
+		void OnNameComponentUpdate(entt::registry& registry, entt::entity entity);
+		void OnNameComponentDestroy(entt::registry& registry, entt::entity entity);
+		void OnRelationshipComponentDestroy(entt::registry& registry, entt::entity entity);
+		void OnTransformComponentConstruct(entt::registry& registry, entt::entity entity);
+		void OnRenderableChanged(entt::registry& registry, entt::entity entity);
+
 		friend class SceneSerializer;
+		friend class BinarySceneSerializer;
+		friend class SceneSnapshot;
+		friend class WorldStreamer;
 	};
 }
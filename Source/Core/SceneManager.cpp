@@ -1,13 +1,21 @@
 #include "SceneManager.h"
 
 #include "SceneSerializer.h"
+#include "../Infrastructure/Logging/Logging.h"
+
+#include <stdexcept>
 
 Mango::Renderer* Mango::SceneManager::_renderer = nullptr;
 Mango::Scene* Mango::SceneManager::_scene = nullptr;
+std::thread Mango::SceneManager::_loadThread;
+std::thread Mango::SceneManager::_teardownThread;
+std::atomic<bool> Mango::SceneManager::_loadFinished = false;
+std::atomic<float> Mango::SceneManager::_loadProgress = 0.0f;
+Mango::Scene* Mango::SceneManager::_loadedScene = nullptr;
 
 Mango::SceneManager::~SceneManager()
 {
-	UnloadScene();
+	Shutdown();
 }
 
 void Mango::SceneManager::SetRenderer(Mango::Renderer* renderer)
@@ -21,12 +29,70 @@ void Mango::SceneManager::LoadFromJson(std::string& sceneJson)
 	Mango::SceneSerializer serializer;
 	_scene = new Mango::Scene(*_renderer);
 	serializer.Populate(*_scene, sceneJson);
+	_scene->CreateScriptEngine();
 }
 
 void Mango::SceneManager::LoadEmpty()
 {
 	UnloadScene();
 	_scene = new Mango::Scene(*_renderer);
+	_scene->CreateScriptEngine();
+}
+
+void Mango::SceneManager::LoadFromFileAsync(const std::filesystem::path& filePath)
+{
+	if (IsLoading())
+	{
+		M_WARN("Scene " << filePath.string() << " is not loaded, another scene is loading");
+		return;
+	}
+
+	_loadFinished = false;
+	_loadProgress = 0.0f;
+	_loadedScene = nullptr;
+	_loadThread = std::thread(RunLoad, filePath);
+}
+
+bool Mango::SceneManager::SwapLoadedScene()
+{
+	if (!IsLoading() || !_loadFinished.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	_loadThread.join();
+	if (_loadedScene == nullptr)
+	{
+		return false;
+	}
+
+	// Python interpreter is process wide, so it's finalized for the old scene before the new scene initializes it
+	Mango::Scene* previousScene = _scene;
+	if (previousScene != nullptr)
+	{
+		previousScene->DestroyScriptEngine();
+	}
+	_scene = _loadedScene;
+	_loadedScene = nullptr;
+	_scene->CreateScriptEngine();
+
+	DestroyInBackground(previousScene);
+	return true;
+}
+
+void Mango::SceneManager::Shutdown()
+{
+	if (_loadThread.joinable())
+	{
+		_loadThread.join();
+		delete _loadedScene;
+		_loadedScene = nullptr;
+	}
+	if (_teardownThread.joinable())
+	{
+		_teardownThread.join();
+	}
+	UnloadScene();
 }
 
 void Mango::SceneManager::UnloadScene()
@@ -37,3 +103,37 @@ void Mango::SceneManager::UnloadScene()
 		_scene = nullptr;
 	}
 }
+
+void Mango::SceneManager::RunLoad(std::filesystem::path filePath)
+{
+	// Staging scene has no script engine, nothing but this thread touches it until it's swapped in
+	Mango::Scene* scene = new Mango::Scene(*_renderer);
+	try
+	{
+		Mango::SceneSerializer serializer;
+		serializer.PopulateFromFile(*scene, filePath, &_loadProgress);
+		_loadedScene = scene;
+	}
+	catch (const std::exception& ex)
+	{
+		M_ERROR("Unable to load scene " << filePath.string() << ": " << ex.what());
+		delete scene;
+	}
+
+	_loadProgress = 1.0f;
+	_loadFinished.store(true, std::memory_order_release);
+}
+
+void Mango::SceneManager::DestroyInBackground(Mango::Scene* scene)
+{
+	if (scene == nullptr)
+	{
+		return;
+	}
+
+	if (_teardownThread.joinable())
+	{
+		_teardownThread.join();
+	}
+	_teardownThread = std::thread([scene]() { delete scene; });
+}
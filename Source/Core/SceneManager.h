@@ -3,7 +3,10 @@
 #include "Scene.h"
 #include "../Render/Renderer.h"
 
+#include <atomic>
+#include <filesystem>
 #include <string>
+#include <thread>
 
 namespace Mango
 {
@@ -19,11 +22,33 @@ namespace Mango
 		static void LoadEmpty();
 		static inline Mango::Scene& GetScene() { return *_scene; };
 
+		// Reads and builds scene on a background thread, current scene stays active until loaded one is swapped in
+		static void LoadFromFileAsync(const std::filesystem::path& filePath);
+		// Called at frame boundary, when no references to current scene are held.
+		// Returns true if loaded scene replaced current one, replaced scene is destroyed on a background thread
+		static bool SwapLoadedScene();
+		static inline bool IsLoading() { return _loadThread.joinable(); }
+		// Fraction of background load done, from 0 to 1
+		static inline float GetLoadProgress() { return _loadProgress.load(std::memory_order_relaxed); }
+
+		// Waits for background threads and destroys current scene
+		static void Shutdown();
+
 	private:
 		static void UnloadScene();
+		static void RunLoad(std::filesystem::path filePath);
+		static void DestroyInBackground(Mango::Scene* scene);
 
 	private:
 		static Mango::Renderer* _renderer;
 		static Mango::Scene* _scene;
+
+		// Background loading
+		static std::thread _loadThread;
+		static std::thread _teardownThread;
+		static std::atomic<bool> _loadFinished;
+		static std::atomic<float> _loadProgress;
+		// Owned by load thread until load is finished, null if load failed
+		static Mango::Scene* _loadedScene;
 	};
 }
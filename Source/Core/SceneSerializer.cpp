@@ -2,197 +2,921 @@
 
 #include "Components/Components.h"
 #include "GUID.h"
+#include "BinarySceneSerializer.h"
+#include "../Infrastructure/IO/FileWriter.h"
+#include "../Infrastructure/IO/MemoryMappedFile.h"
+#include "../Infrastructure/Jobs/JobSystem.h"
+#include "../Infrastructure/Logging/Logging.h"
 
 #include <glm/glm.hpp>
 
-#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
-std::string Mango::SceneSerializer::Serialize(Mango::Scene& scene)
+class Mango::SceneSerializer::SaxHandler : public nlohmann::json_sax<nlohmann::json>
 {
-	nlohmann::json json;
+public:
+	SaxHandler(Mango::SceneSerializer& serializer, Mango::Scene& scene, std::istream& stream, size_t streamSize, std::atomic<float>* progress)
+		: _serializer(serializer), _scene(scene), _stream(stream), _streamSize(streamSize), _progress(progress) {}
 
-	const auto count = scene._registry.size();
-	const entt::entity* entity = scene._registry.data();
+	// Parent could be stored after its children, so hierarchy is linked once all entities exist
+	std::vector<std::pair<entt::entity, Mango::GUID>> Parents;
+	std::string WorldManifestPath;
+
+	// Create entities decoded since the last commit
+	void Commit()
+	{
+		_serializer.CommitEntities(_scene, _staged, Parents);
+		_staged.Clear();
+		if (_progress != nullptr && _streamSize > 0)
+		{
+			const auto position = _stream.rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in);
+			if (position != std::streampos(-1))
+			{
+				_progress->store(static_cast<float>(position) / _streamSize, std::memory_order_relaxed);
+			}
+		}
+	}
 
-	json["entities"] = nlohmann::json::array();
+	bool null() override { return AddValue(nullptr); }
+	bool boolean(bool value) override { return AddValue(value); }
+	bool number_integer(number_integer_t value) override { return AddValue(value); }
+	bool number_unsigned(number_unsigned_t value) override { return AddValue(value); }
+	bool number_float(number_float_t value, const string_t&) override { return AddValue(value); }
+	bool binary(binary_t& value) override { return AddValue(std::move(value)); }
 
-	for (auto i = 0; i < count; i++, entity++)
+	bool string(string_t& value) override
 	{
-		auto currentEntity = nlohmann::json::object();
-		currentEntity["components"] = nlohmann::json::object();
+		if (_elementStack.empty() && _depth == 1 && _section == Section::World)
+		{
+			WorldManifestPath = value;
+			return true;
+		}
+		return AddValue(std::move(value));
+	}
+
+	bool start_object(std::size_t) override { return BeginContainer(nlohmann::json::object()); }
+	bool end_object() override { return EndContainer(); }
+	bool start_array(std::size_t) override { return BeginContainer(nlohmann::json::array()); }
+	bool end_array() override { return EndContainer(); }
 
-		// IdComponent
-		const auto id = scene._registry.try_get<IdComponent>(*entity);
-		if (id != nullptr)
+	bool key(string_t& key) override
+	{
+		if (!_elementStack.empty())
 		{
-			currentEntity["components"]["idComponent"] = nlohmann::json::object({ {"id", static_cast<uint64_t>(id->GetId())} });
+			_elementKey = key;
 		}
+		else if (_depth == 1)
+		{
+			// Sections are optional, unknown ones are skipped
+			_section = key == "entities" ? Section::Entities : key == "prefabs" ? Section::Prefabs : key == "world" ? Section::World : Section::None;
+		}
+		return true;
+	}
+
+	bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override
+	{
+		throw std::runtime_error(ex.what());
+	}
+
+private:
+	enum class Section
+	{
+		None,
+		Entities,
+		Prefabs,
+		World
+	};
+
+	Mango::SceneSerializer& _serializer;
+	Mango::Scene& _scene;
+	std::istream& _stream;
+	size_t _streamSize;
+	std::atomic<float>* _progress;
+	Mango::SceneSerializer::StagedEntities _staged;
 
-		// NameComponent
-		const auto name = scene._registry.try_get<NameComponent>(*entity);
-		if (name != nullptr)
+	size_t _depth = 0;
+	Section _section = Section::None;
+
+	// Entity or prefab being parsed and path to its innermost open container
+	nlohmann::json _element;
+	std::vector<nlohmann::json*> _elementStack;
+	std::string _elementKey;
+
+private:
+	template<typename Value>
+	bool AddValue(Value&& value)
+	{
+		// Values outside of entities and prefabs are skipped
+		if (_elementStack.empty())
 		{
-			currentEntity["components"]["nameComponent"] = nlohmann::json::object({ { "name", std::string(name->GetName()) } });
+			return true;
 		}
 
-		// TransformComponent
-		const auto transform = scene._registry.try_get<TransformComponent>(*entity);
-		if (transform != nullptr)
+		auto& container = *_elementStack.back();
+		if (container.is_array())
 		{
-			const auto translation = transform->GetTranslation();
-			const auto rotation = transform->GetRotation();
-			const auto scale = transform->GetScale();
+			container.emplace_back(std::forward<Value>(value));
+		}
+		else
+		{
+			container[_elementKey] = std::forward<Value>(value);
+		}
+		return true;
+	}
 
-			currentEntity["components"]["transformComponent"] = nlohmann::json::object({
-				{ "translation", nlohmann::json::array({ translation.x, translation.y, translation.z }) },
-				{ "rotation", nlohmann::json::array({ rotation.x, rotation.y, rotation.z })},
-				{ "scale", nlohmann::json::array({ scale.x, scale.y, scale.z }) }
-			});
+	bool BeginContainer(nlohmann::json&& container)
+	{
+		// Only open containers are referenced, their parents don't grow until they are closed
+		if (!_elementStack.empty())
+		{
+			auto& parent = *_elementStack.back();
+			auto& child = parent.is_array() ? parent.emplace_back(std::move(container)) : (parent[_elementKey] = std::move(container));
+			_elementStack.push_back(&child);
+		}
+		else if (_depth == 2 && (_section == Section::Entities || _section == Section::Prefabs))
+		{
+			_element = std::move(container);
+			_elementStack.push_back(&_element);
 		}
 
-		// ColorComponent
-		const auto color = scene._registry.try_get<ColorComponent>(*entity);
-		if (color != nullptr)
+		_depth++;
+		return true;
+	}
+
+	bool EndContainer()
+	{
+		_depth--;
+		if (_elementStack.empty())
 		{
-			const auto colorVec = color->GetColor();
-			currentEntity["components"]["colorComponent"] = nlohmann::json::object({
-				{ "color", nlohmann::json::array({ colorVec.r, colorVec.g, colorVec.b, colorVec.a }) }
-			});
+			return true;
 		}
 
-		// GeometryComponent
-		const auto geometry = scene._registry.try_get<GeometryComponent>(*entity);
-		if (geometry != nullptr)
+		_elementStack.pop_back();
+		if (!_elementStack.empty())
 		{
-			currentEntity["components"]["geometryComponent"] = nlohmann::json::object({ { "geometry", geometry->GetGeometry() } });
+			return true;
 		}
 
-		// CameraComponent
-		const auto camera = scene._registry.try_get<CameraComponent>(*entity);
-		if (camera != nullptr)
+		if (_section == Section::Entities)
+		{
+			_serializer.DecodeEntity(_element, _staged);
+			if (_staged.GetSize() >= _chunkSize)
+			{
+				Commit();
+			}
+		}
+		else
 		{
-			currentEntity["components"]["cameraComponent"] = nlohmann::json::object({
-				{ "nearPlane", camera->GetNearPlane() },
-				{ "farPlane", camera->GetFarPlane() },
-				{ "fovDegrees", camera->GetFOV() },
-				{ "isPrimary", camera->IsPrimary() },
-				{ "isEditorCamera", camera->IsEditorCamera() }
-			});
+			_scene.RegisterPrefab(_serializer.PopulatePrefab(_element));
 		}
+		_element = nullptr;
+		return true;
+	}
+};
+
+void Mango::SceneSerializer::Serialize(Mango::Scene& scene, std::ostream& stream)
+{
+	Mango::JsonStreamWriter writer(stream);
+	writer.BeginObject();
 
-		// RigidbodyComponent
-		const auto rigidbody = scene._registry.try_get<RigidbodyComponent>(*entity);
-		if (rigidbody != nullptr)
+	writer.Key("entities");
+	writer.BeginArray();
+	const auto count = scene._registry.size();
+	const entt::entity* entity = scene._registry.data();
+	for (auto i = 0; i < count; i++, entity++)
+	{
+		// Streamed entities are saved in their chunk files, scene only keeps path to world manifest
+		if (scene._registry.all_of<ChunkComponent>(*entity))
 		{
-			currentEntity["components"]["rigidbodyComponent"] = nlohmann::json::object({
-				{ "isDynamic", rigidbody->IsDynamic() }
-			});
+			continue;
 		}
 
-		// ScriptComponent
-		const auto script = scene._registry.try_get<ScriptComponent>(*entity);
-		if (script != nullptr)
+		SerializeEntity(scene, *entity, writer);
+	}
+	writer.EndArray();
+
+	writer.Key("prefabs");
+	writer.BeginArray();
+	for (const auto& [_, prefab] : scene.GetPrefabs())
+	{
+		SerializePrefab(prefab, writer);
+	}
+	writer.EndArray();
+
+	if (scene._worldStreamer != nullptr)
+	{
+		writer.Key("world");
+		writer.Value(scene._worldStreamer->GetManifestPath().string());
+	}
+
+	writer.EndObject();
+}
+
+void Mango::SceneSerializer::Populate(Mango::Scene& scene, std::istream& stream, size_t streamSize, std::atomic<float>* progress)
+{
+	SaxHandler handler(*this, scene, stream, streamSize, progress);
+	nlohmann::json::sax_parse(stream, &handler);
+	handler.Commit();
+	LinkParents(scene, handler.Parents);
+
+	// Streamed world is optional, its chunks are loaded once scene is updated
+	if (!handler.WorldManifestPath.empty())
+	{
+		scene.OpenWorld(handler.WorldManifestPath);
+	}
+}
+
+void Mango::SceneSerializer::Populate(Mango::Scene& scene, std::string& sceneJson, std::atomic<float>* progress)
+{
+	PopulateParallel(scene, sceneJson, progress);
+}
+
+void Mango::SceneSerializer::PopulateFromFile(Mango::Scene& scene, const std::filesystem::path& filePath, std::atomic<float>* progress, bool useJobs)
+{
+	if (IsBinaryScene(filePath))
+	{
+		// Columns are read straight from mapped file, file is only needed while scene is populated
+		Mango::MemoryMappedFile file(filePath);
+		Mango::BinarySceneSerializer serializer;
+		serializer.Populate(scene, file.GetData(), file.GetSize(), progress, useJobs);
+		return;
+	}
+
+	// Without worker threads file is streamed, so only one chunk of entities is kept in memory
+	if (!useJobs || Mango::JobSystem::GetThreadsCount() <= 1)
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		if (!file.is_open())
 		{
-			currentEntity["components"]["scriptComponent"] = nlohmann::json::object({
-				{ "scriptFileName", std::string(script->GetFileName()) }
-			});
+			throw std::runtime_error("Failed to open file: " + filePath.string());
 		}
+		Populate(scene, file, static_cast<size_t>(std::filesystem::file_size(filePath)), progress);
+		return;
+	}
+
+	Mango::MemoryMappedFile file(filePath);
+	PopulateParallel(scene, std::string_view(reinterpret_cast<const char*>(file.GetData()), file.GetSize()), progress);
+}
 
-		json["entities"].push_back(currentEntity);
+void Mango::SceneSerializer::SerializeToFile(Mango::Scene& scene, const std::filesystem::path& filePath)
+{
+	if (IsBinaryScene(filePath))
+	{
+		Mango::BinarySceneSerializer serializer;
+		Mango::FileWriter::WriteFile(filePath, serializer.Serialize(scene));
+		return;
 	}
 
-	return json.dump(4);
+	Mango::FileWriter::WriteFile(filePath, [this, &scene](std::ostream& stream) { Serialize(scene, stream); });
 }
 
-void Mango::SceneSerializer::Populate(Mango::Scene& scene, std::string& sceneJson)
+void Mango::SceneSerializer::SerializeEntity(Mango::Scene& scene, entt::entity entity, Mango::JsonStreamWriter& writer)
 {
-	auto json = nlohmann::json::parse(sceneJson);
-	const auto& entities = json["entities"];
 	auto& registry = scene._registry;
+	writer.BeginObject();
+	writer.Key("components");
+	writer.BeginObject();
+
+	// IdComponent
+	const auto id = registry.try_get<IdComponent>(entity);
+	if (id != nullptr)
+	{
+		writer.Key("idComponent");
+		writer.BeginObject();
+		writer.Key("id");
+		writer.Value(static_cast<uint64_t>(id->GetId()));
+		writer.EndObject();
+	}
+
+	// NameComponent
+	const auto name = registry.try_get<NameComponent>(entity);
+	if (name != nullptr)
+	{
+		writer.Key("nameComponent");
+		writer.BeginObject();
+		writer.Key("name");
+		writer.Value(name->GetName());
+		writer.EndObject();
+	}
+
+	// TransformComponent
+	const auto transform = registry.try_get<TransformComponent>(entity);
+	if (transform != nullptr)
+	{
+		writer.Key("transformComponent");
+		SerializeTransform(transform->GetTranslation(), transform->GetRotation(), transform->GetScale(), writer);
+	}
+
+	// ColorComponent
+	const auto color = registry.try_get<ColorComponent>(entity);
+	if (color != nullptr)
+	{
+		const auto colorVec = color->GetColor();
+		writer.Key("colorComponent");
+		writer.BeginObject();
+		writer.Key("color");
+		writer.BeginArray();
+		writer.Value(colorVec.r);
+		writer.Value(colorVec.g);
+		writer.Value(colorVec.b);
+		writer.Value(colorVec.a);
+		writer.EndArray();
+		writer.EndObject();
+	}
+
+	// GeometryComponent
+	const auto geometry = registry.try_get<GeometryComponent>(entity);
+	if (geometry != nullptr)
+	{
+		writer.Key("geometryComponent");
+		writer.BeginObject();
+		writer.Key("geometry");
+		writer.Value(static_cast<int32_t>(geometry->GetGeometry()));
+		writer.EndObject();
+	}
+
+	// CameraComponent
+	const auto camera = registry.try_get<CameraComponent>(entity);
+	if (camera != nullptr)
+	{
+		writer.Key("cameraComponent");
+		writer.BeginObject();
+		writer.Key("nearPlane");
+		writer.Value(camera->GetNearPlane());
+		writer.Key("farPlane");
+		writer.Value(camera->GetFarPlane());
+		writer.Key("fovDegrees");
+		writer.Value(camera->GetFOV());
+		writer.Key("isPrimary");
+		writer.Value(camera->IsPrimary());
+		writer.Key("isEditorCamera");
+		writer.Value(camera->IsEditorCamera());
+		writer.EndObject();
+	}
+
+	// RigidbodyComponent
+	const auto rigidbody = registry.try_get<RigidbodyComponent>(entity);
+	if (rigidbody != nullptr)
+	{
+		writer.Key("rigidbodyComponent");
+		writer.BeginObject();
+		writer.Key("bodyType");
+		writer.Value(static_cast<int32_t>(rigidbody->GetType()));
+		writer.EndObject();
+	}
 
-	for (auto it = entities.begin(); it != entities.end(); it++)
+	// ScriptComponent
+	const auto script = registry.try_get<ScriptComponent>(entity);
+	if (script != nullptr)
 	{
-		entt::entity entity = registry.create();
+		writer.Key("scriptComponent");
+		writer.BeginObject();
+		writer.Key("scriptFileName");
+		writer.Value(script->GetFileName());
+		writer.EndObject();
+	}
 
-		const auto& currentComponents = (*it)["components"];
+	// RelationshipComponent
+	const auto relationship = registry.try_get<RelationshipComponent>(entity);
+	if (relationship != nullptr && relationship->GetParent() != entt::null)
+	{
+		const auto parentId = registry.get<IdComponent>(relationship->GetParent()).GetId();
+		writer.Key("relationshipComponent");
+		writer.BeginObject();
+		writer.Key("parent");
+		writer.Value(static_cast<uint64_t>(parentId));
+		writer.EndObject();
+	}
 
-		// IdComponent
-		EnsureComponentExists(currentComponents, "idComponent");
-		uint64_t idValue = currentComponents["idComponent"]["id"];
-		Mango::GUID id(idValue);
-		auto& idComponent = registry.emplace<IdComponent>(entity, id);
+	writer.EndObject();
+	writer.EndObject();
+}
 
-		// NameComponent
-		EnsureComponentExists(currentComponents, "nameComponent");
-		std::string name = currentComponents["nameComponent"]["name"];
-		registry.emplace<NameComponent>(entity, name);
-		
-		// TransformComponent
-		EnsureComponentExists(currentComponents, "transformComponent");
-		const auto& transformJson = currentComponents["transformComponent"];
-		glm::vec3 translation = glm::vec3(transformJson["translation"][0], transformJson["translation"][1], transformJson["translation"][2]);
-		glm::vec3 rotation = glm::vec3(transformJson["rotation"][0], transformJson["rotation"][1], transformJson["rotation"][2]);
-		glm::vec3 scale = glm::vec3(transformJson["scale"][0], transformJson["scale"][1], transformJson["scale"][2]);
-		registry.emplace<TransformComponent>(entity, translation, rotation, scale);
+void Mango::SceneSerializer::SerializePrefab(const Mango::Prefab& prefab, Mango::JsonStreamWriter& writer)
+{
+	writer.BeginObject();
+	writer.Key("name");
+	writer.Value(prefab.Name);
+	writer.Key("components");
+	writer.BeginObject();
 
-		// ColorComponent
-		if (currentComponents.contains("colorComponent"))
+	writer.Key("transformComponent");
+	SerializeTransform(prefab.Translation, prefab.Rotation, prefab.Scale, writer);
+	if (prefab.Color.has_value())
+	{
+		const auto& color = prefab.Color.value();
+		writer.Key("colorComponent");
+		writer.BeginObject();
+		writer.Key("color");
+		writer.BeginArray();
+		writer.Value(color.r);
+		writer.Value(color.g);
+		writer.Value(color.b);
+		writer.Value(color.a);
+		writer.EndArray();
+		writer.EndObject();
+	}
+	if (prefab.Geometry.has_value())
+	{
+		writer.Key("geometryComponent");
+		writer.BeginObject();
+		writer.Key("geometry");
+		writer.Value(static_cast<int32_t>(prefab.Geometry.value()));
+		writer.EndObject();
+	}
+	if (prefab.Rigidbody.has_value())
+	{
+		writer.Key("rigidbodyComponent");
+		writer.BeginObject();
+		writer.Key("bodyType");
+		writer.Value(static_cast<int32_t>(prefab.Rigidbody.value()));
+		writer.EndObject();
+	}
+	if (prefab.ScriptFileName.has_value())
+	{
+		writer.Key("scriptComponent");
+		writer.BeginObject();
+		writer.Key("scriptFileName");
+		writer.Value(prefab.ScriptFileName.value());
+		writer.EndObject();
+	}
+
+	writer.EndObject();
+	writer.EndObject();
+}
+
+void Mango::SceneSerializer::SerializeTransform(glm::vec3 translation, glm::vec3 rotation, glm::vec3 scale, Mango::JsonStreamWriter& writer)
+{
+	writer.BeginObject();
+	const std::pair<const char*, glm::vec3> vectors[] = { { "translation", translation }, { "rotation", rotation }, { "scale", scale } };
+	for (const auto& [key, vector] : vectors)
+	{
+		writer.Key(key);
+		writer.BeginArray();
+		writer.Value(vector.x);
+		writer.Value(vector.y);
+		writer.Value(vector.z);
+		writer.EndArray();
+	}
+	writer.EndObject();
+}
+
+void Mango::SceneSerializer::PopulateParallel(Mango::Scene& scene, std::string_view sceneJson, std::atomic<float>* progress)
+{
+	std::vector<std::string_view> entities;
+	std::string_view prefabs;
+	std::string_view world;
+	SplitScene(sceneJson, entities, prefabs, world);
+
+	if (!prefabs.empty())
+	{
+		for (const auto& prefabJson : nlohmann::json::parse(prefabs))
 		{
-			const auto& colorJson = currentComponents["colorComponent"];
-			glm::vec4 color = glm::vec4(colorJson["color"][0], colorJson["color"][1], colorJson["color"][2], colorJson["color"][3]);
-			registry.emplace<ColorComponent>(entity, color);
+			scene.RegisterPrefab(PopulatePrefab(prefabJson));
 		}
-		
-		// GeometryComponent
-		if (currentComponents.contains("geometryComponent"))
+	}
+
+	// Every chunk is decoded by one job into its own staging buffer. Registry and physics world aren't thread safe,
+	// so chunks are committed on this thread in file order as soon as they are decoded
+	const size_t chunksCount = (entities.size() + _chunkSize - 1) / _chunkSize;
+	const size_t chunksInFlight = 2 * static_cast<size_t>(Mango::JobSystem::GetThreadsCount());
+	std::vector<StagedEntities> chunks(chunksCount);
+	std::vector<std::string> errors(chunksCount);
+	auto counters = std::make_unique<Mango::JobCounter[]>(chunksCount);
+	size_t submittedCount = 0;
+	auto submitChunks = [&](size_t limit)
+	{
+		for (; submittedCount < std::min(limit, chunksCount); submittedCount++)
 		{
-			Mango::GeometryType geometry = currentComponents["geometryComponent"]["geometry"];
-			registry.emplace<GeometryComponent>(entity, geometry);
+			const size_t chunkIndex = submittedCount;
+			Mango::JobSystem::Submit([this, &entities, &chunks, &errors, chunkIndex]()
+			{
+				// Exceptions can't leave a job, error is rethrown when chunk is committed
+				try
+				{
+					const size_t first = chunkIndex * _chunkSize;
+					const size_t last = std::min(first + _chunkSize, entities.size());
+					for (size_t i = first; i < last; i++)
+					{
+						DecodeEntity(nlohmann::json::parse(entities[i]), chunks[chunkIndex]);
+					}
+				}
+				catch (const std::exception& ex)
+				{
+					errors[chunkIndex] = ex.what();
+				}
+			}, &counters[chunkIndex]);
 		}
-		
-		// CameraComponent
-		if (currentComponents.contains("cameraComponent"))
+	};
+
+	std::vector<std::pair<entt::entity, Mango::GUID>> parents;
+	try
+	{
+		for (size_t chunkIndex = 0; chunkIndex < chunksCount; chunkIndex++)
+		{
+			submitChunks(chunkIndex + chunksInFlight);
+			Mango::JobSystem::Wait(counters[chunkIndex]);
+			if (!errors[chunkIndex].empty())
+			{
+				throw std::runtime_error(errors[chunkIndex]);
+			}
+
+			CommitEntities(scene, chunks[chunkIndex], parents);
+			chunks[chunkIndex] = StagedEntities();
+			if (progress != nullptr)
+			{
+				progress->store(static_cast<float>(chunkIndex + 1) / chunksCount, std::memory_order_relaxed);
+			}
+		}
+	}
+	catch (...)
+	{
+		// Jobs write into local staging buffers, so every submitted chunk is finished before they go away
+		for (size_t chunkIndex = 0; chunkIndex < submittedCount; chunkIndex++)
+		{
+			Mango::JobSystem::Wait(counters[chunkIndex]);
+		}
+		throw;
+	}
+	LinkParents(scene, parents);
+
+	// Streamed world is optional, its chunks are loaded once scene is updated
+	if (!world.empty())
+	{
+		scene.OpenWorld(nlohmann::json::parse(world).get<std::string>());
+	}
+}
+
+void Mango::SceneSerializer::SplitScene(std::string_view sceneJson, std::vector<std::string_view>& entities, std::string_view& prefabs, std::string_view& world)
+{
+	size_t position = SkipWhitespace(sceneJson, 0);
+	if (sceneJson[position] != '{')
+	{
+		throw std::runtime_error("Scene JSON is not an object");
+	}
+	position = SkipWhitespace(sceneJson, position + 1);
+	if (sceneJson[position] == '}')
+	{
+		return;
+	}
+
+	while (true)
+	{
+		// Keys of scene sections never contain escape sequences
+		if (sceneJson[position] != '"')
+		{
+			throw std::runtime_error("Scene JSON has malformed section name");
+		}
+		const size_t keyEnd = SkipValue(sceneJson, position);
+		const auto key = sceneJson.substr(position + 1, keyEnd - position - 2);
+		position = SkipWhitespace(sceneJson, keyEnd);
+		if (sceneJson[position] != ':')
+		{
+			throw std::runtime_error("Scene JSON has malformed section " + std::string(key));
+		}
+		position = SkipWhitespace(sceneJson, position + 1);
+		const size_t valueEnd = SkipValue(sceneJson, position);
+
+		if (key == "entities")
+		{
+			if (sceneJson[position] != '[')
+			{
+				throw std::runtime_error("Scene JSON entities are not an array");
+			}
+
+			size_t element = SkipWhitespace(sceneJson, position + 1);
+			while (sceneJson[element] != ']')
+			{
+				const size_t elementEnd = SkipValue(sceneJson, element);
+				entities.push_back(sceneJson.substr(element, elementEnd - element));
+				element = SkipWhitespace(sceneJson, elementEnd);
+				if (sceneJson[element] == ',')
+				{
+					element = SkipWhitespace(sceneJson, element + 1);
+				}
+				else if (sceneJson[element] != ']')
+				{
+					throw std::runtime_error("Scene JSON has malformed entities array");
+				}
+			}
+		}
+		else if (key == "prefabs")
+		{
+			prefabs = sceneJson.substr(position, valueEnd - position);
+		}
+		else if (key == "world")
 		{
-			const auto& cameraJson = currentComponents["cameraComponent"];
-			float nearPlane = cameraJson["nearPlane"];
-			float farPlane = cameraJson["farPlane"];
-			float fovDegrees = cameraJson["fovDegrees"];
-			bool isPrimary = cameraJson["isPrimary"];
-			bool isEditorCamera = cameraJson["isEditorCamera"];
-			auto& camera = registry.emplace<CameraComponent>(entity, isEditorCamera);
-			camera.SetClippingPlanes(nearPlane, farPlane);
-			camera.SetFOV(fovDegrees);
-			camera.SetPrimary(isPrimary);
+			world = sceneJson.substr(position, valueEnd - position);
 		}
 
-		// RigidbodyComponent
-		if (currentComponents.contains("rigidbodyComponent"))
+		// Sections are optional, unknown ones are skipped
+		position = SkipWhitespace(sceneJson, valueEnd);
+		if (sceneJson[position] == '}')
+		{
+			return;
+		}
+		if (sceneJson[position] != ',')
 		{
-			// Get reference to this Id from created component to make sure that reference will point to valid memory address
-			auto& safeId = idComponent.GetId();
+			throw std::runtime_error("Scene JSON has malformed section " + std::string(key));
+		}
+		position = SkipWhitespace(sceneJson, position + 1);
+	}
+}
+
+size_t Mango::SceneSerializer::SkipWhitespace(std::string_view json, size_t position)
+{
+	while (position < json.size() && (json[position] == ' ' || json[position] == '\n' || json[position] == '\r' || json[position] == '\t'))
+	{
+		position++;
+	}
+
+	// Callers always expect another token
+	if (position >= json.size())
+	{
+		throw std::runtime_error("Unexpected end of scene JSON");
+	}
+	return position;
+}
 
-			const auto& rigidbodyJson = currentComponents["rigidbodyComponent"];
-			bool isDynamic = rigidbodyJson["isDynamic"];
-			b2BodyDef bodyDefinition;
-			bodyDefinition.userData.pointer = reinterpret_cast<uintptr_t>(&safeId);
-			b2Body* body = scene._physicsWorld.CreateBody(&bodyDefinition);
-			auto& component = registry.emplace<RigidbodyComponent>(entity, body);
-			component.SetDynamic(isDynamic);
+size_t Mango::SceneSerializer::SkipValue(std::string_view json, size_t position)
+{
+	// Nested containers are skipped by counting brackets outside of strings
+	size_t depth = 0;
+	bool inString = false;
+	for (; position < json.size(); position++)
+	{
+		const char character = json[position];
+		if (inString)
+		{
+			if (character == '\\')
+			{
+				position++;
+			}
+			else if (character == '"')
+			{
+				inString = false;
+				if (depth == 0)
+				{
+					return position + 1;
+				}
+			}
+			continue;
+		}
+
+		switch (character)
+		{
+		case '"':
+			inString = true;
+			break;
+		case '{':
+		case '[':
+			depth++;
+			break;
+		case '}':
+		case ']':
+			if (depth == 0)
+			{
+				// End of enclosing container terminates number or literal
+				return position;
+			}
+			if (--depth == 0)
+			{
+				return position + 1;
+			}
+			break;
+		case ',':
+		case ' ':
+		case '\n':
+		case '\r':
+		case '\t':
+			if (depth == 0)
+			{
+				return position;
+			}
+			break;
 		}
+	}
 
-		// ScriptComponent
-		if (currentComponents.contains("scriptComponent"))
+	if (inString || depth > 0)
+	{
+		throw std::runtime_error("Unexpected end of scene JSON");
+	}
+	return position;
+}
+
+void Mango::SceneSerializer::DecodeEntity(const nlohmann::json& entityJson, StagedEntities& staged)
+{
+	EnsureComponentExists(entityJson, "components");
+	const auto& currentComponents = entityJson["components"];
+	EnsureComponentExists(currentComponents, "idComponent");
+	EnsureComponentExists(currentComponents, "nameComponent");
+	EnsureComponentExists(currentComponents, "transformComponent");
+	const auto row = static_cast<uint32_t>(staged.GetSize());
+
+	// IdComponent
+	uint64_t idValue = currentComponents["idComponent"]["id"];
+	staged.Ids.emplace_back(Mango::GUID(idValue));
+
+	// NameComponent
+	const auto& name = currentComponents["nameComponent"]["name"].get_ref<const std::string&>();
+	staged.Names.emplace_back(name);
+
+	// TransformComponent
+	const auto& transformJson = currentComponents["transformComponent"];
+	glm::vec3 translation = glm::vec3(transformJson["translation"][0], transformJson["translation"][1], transformJson["translation"][2]);
+	glm::vec3 rotation = glm::vec3(transformJson["rotation"][0], transformJson["rotation"][1], transformJson["rotation"][2]);
+	glm::vec3 scale = glm::vec3(transformJson["scale"][0], transformJson["scale"][1], transformJson["scale"][2]);
+	staged.Transforms.emplace_back(translation, rotation, scale);
+
+	// ColorComponent
+	if (currentComponents.contains("colorComponent"))
+	{
+		const auto& colorJson = currentComponents["colorComponent"];
+		glm::vec4 color = glm::vec4(colorJson["color"][0], colorJson["color"][1], colorJson["color"][2], colorJson["color"][3]);
+		staged.ColorRows.push_back(row);
+		staged.Colors.emplace_back(color);
+	}
+
+	// GeometryComponent
+	if (currentComponents.contains("geometryComponent"))
+	{
+		Mango::GeometryType geometry = currentComponents["geometryComponent"]["geometry"];
+		staged.GeometryRows.push_back(row);
+		staged.Geometries.emplace_back(geometry);
+	}
+
+	// CameraComponent
+	if (currentComponents.contains("cameraComponent"))
+	{
+		const auto& cameraJson = currentComponents["cameraComponent"];
+		float nearPlane = cameraJson["nearPlane"];
+		float farPlane = cameraJson["farPlane"];
+		float fovDegrees = cameraJson["fovDegrees"];
+		bool isPrimary = cameraJson["isPrimary"];
+		bool isEditorCamera = cameraJson["isEditorCamera"];
+		auto& camera = staged.Cameras.emplace_back(isEditorCamera);
+		camera.SetClippingPlanes(nearPlane, farPlane);
+		camera.SetFOV(fovDegrees);
+		camera.SetPrimary(isPrimary);
+		staged.CameraRows.push_back(row);
+	}
+
+	// RigidbodyComponent. Bodies are created on commit, physics world isn't thread safe
+	if (currentComponents.contains("rigidbodyComponent"))
+	{
+		staged.RigidbodyRows.push_back(row);
+		staged.RigidbodyTypes.push_back(ReadRigidbodyType(currentComponents["rigidbodyComponent"]));
+	}
+
+	// ScriptComponent
+	if (currentComponents.contains("scriptComponent"))
+	{
+		const auto& scriptJson = currentComponents["scriptComponent"];
+		auto& script = staged.Scripts.emplace_back();
+		script.SetFileName(scriptJson["scriptFileName"].get_ref<const std::string&>());
+		staged.ScriptRows.push_back(row);
+	}
+
+	// RelationshipComponent
+	if (currentComponents.contains("relationshipComponent"))
+	{
+		uint64_t parentId = currentComponents["relationshipComponent"]["parent"];
+		staged.Parents.emplace_back(row, Mango::GUID(parentId));
+	}
+}
+
+void Mango::SceneSerializer::CommitEntities(Mango::Scene& scene, StagedEntities& staged, std::vector<std::pair<entt::entity, Mango::GUID>>& parents)
+{
+	const size_t count = staged.GetSize();
+	if (count == 0)
+	{
+		return;
+	}
+
+	auto& registry = scene._registry;
+	std::vector<entt::entity> entities(count);
+	registry.create(entities.begin(), entities.end());
+	registry.insert<IdComponent>(entities.begin(), entities.end(), staged.Ids.begin());
+	registry.insert<NameComponent>(entities.begin(), entities.end(), staged.Names.begin());
+	registry.insert<TransformComponent>(entities.begin(), entities.end(), staged.Transforms.begin());
+
+	std::vector<entt::entity> rowEntities;
+	auto insertRows = [&registry, &entities, &rowEntities](const std::vector<uint32_t>& rows, auto& components)
+	{
+		using Component = typename std::decay_t<decltype(components)>::value_type;
+		rowEntities.resize(rows.size());
+		for (size_t i = 0; i < rows.size(); i++)
+		{
+			rowEntities[i] = entities[rows[i]];
+		}
+		registry.insert<Component>(rowEntities.begin(), rowEntities.end(), components.begin());
+	};
+	insertRows(staged.ColorRows, staged.Colors);
+	insertRows(staged.GeometryRows, staged.Geometries);
+	insertRows(staged.CameraRows, staged.Cameras);
+	insertRows(staged.ScriptRows, staged.Scripts);
+
+	// Every rigidbody owns its own Box2D body, so they can't be inserted in bulk
+	for (size_t i = 0; i < staged.RigidbodyRows.size(); i++)
+	{
+		const auto entity = entities[staged.RigidbodyRows[i]];
+		b2BodyDef bodyDefinition;
+		bodyDefinition.userData.pointer = static_cast<uintptr_t>(static_cast<uint64_t>(registry.get<IdComponent>(entity).GetId()));
+		b2Body* body = scene._physicsWorld.CreateBody(&bodyDefinition);
+		auto& rigidbody = registry.emplace<RigidbodyComponent>(entity, body);
+		rigidbody.SetType(staged.RigidbodyTypes[i]);
+	}
+
+	for (const auto& [row, parentId] : staged.Parents)
+	{
+		parents.emplace_back(entities[row], parentId);
+	}
+}
+
+void Mango::SceneSerializer::LinkParents(Mango::Scene& scene, const std::vector<std::pair<entt::entity, Mango::GUID>>& parents)
+{
+	for (const auto& [entity, parentId] : parents)
+	{
+		const auto parent = scene.GetEntityById(parentId);
+		if (!scene._registry.valid(parent) || !scene.SetEntityParent(entity, parent))
+		{
+			M_WARN("Unable to restore parent " << static_cast<uint64_t>(parentId) << " of entity " << static_cast<uint64_t>(scene._registry.get<IdComponent>(entity).GetId()));
+		}
+	}
+}
+
+void Mango::SceneSerializer::StagedEntities::Clear()
+{
+	Ids.clear();
+	Names.clear();
+	Transforms.clear();
+	ColorRows.clear();
+	Colors.clear();
+	GeometryRows.clear();
+	Geometries.clear();
+	CameraRows.clear();
+	Cameras.clear();
+	RigidbodyRows.clear();
+	RigidbodyTypes.clear();
+	ScriptRows.clear();
+	Scripts.clear();
+	Parents.clear();
+}
+
+Mango::Prefab Mango::SceneSerializer::PopulatePrefab(const nlohmann::json& prefabJson)
+{
+	Mango::Prefab prefab;
+	prefab.Name = prefabJson["name"];
+	const auto& components = prefabJson["components"];
+
+	// Components missing in prefab JSON keep their default values
+	if (components.contains("transformComponent"))
+	{
+		const auto& transformJson = components["transformComponent"];
+		prefab.Translation = glm::vec3(transformJson["translation"][0], transformJson["translation"][1], transformJson["translation"][2]);
+		prefab.Rotation = glm::vec3(transformJson["rotation"][0], transformJson["rotation"][1], transformJson["rotation"][2]);
+		prefab.Scale = glm::vec3(transformJson["scale"][0], transformJson["scale"][1], transformJson["scale"][2]);
+	}
+	if (components.contains("colorComponent"))
+	{
+		const auto& colorJson = components["colorComponent"];
+		prefab.Color = glm::vec4(colorJson["color"][0], colorJson["color"][1], colorJson["color"][2], colorJson["color"][3]);
+	}
+	if (components.contains("geometryComponent"))
+	{
+		prefab.Geometry = components["geometryComponent"]["geometry"].get<Mango::GeometryType>();
+	}
+	if (components.contains("rigidbodyComponent"))
+	{
+		prefab.Rigidbody = ReadRigidbodyType(components["rigidbodyComponent"]);
+	}
+	if (components.contains("scriptComponent"))
+	{
+		prefab.ScriptFileName = components["scriptComponent"]["scriptFileName"].get<std::string>();
+	}
+	return prefab;
+}
+
+Mango::RigidbodyType Mango::SceneSerializer::ReadRigidbodyType(const nlohmann::json& rigidbodyJson)
+{
+	if (rigidbodyJson.contains("bodyType"))
+	{
+		const auto bodyType = rigidbodyJson["bodyType"].get<int64_t>();
+		if (bodyType < 0 || bodyType > static_cast<int64_t>(Mango::RigidbodyType::Kinematic))
 		{
-			const auto& scriptJson = currentComponents["scriptComponent"];
-			std::string scriptFileName = scriptJson["scriptFileName"];
-			auto& script = registry.emplace<ScriptComponent>(entity);
-			script.SetFileName(scriptFileName);
+			throw std::runtime_error("Scene file has unknown body type " + std::to_string(bodyType));
 		}
+		return static_cast<Mango::RigidbodyType>(bodyType);
 	}
+	return rigidbodyJson["isDynamic"].get<bool>() ? Mango::RigidbodyType::Dynamic : Mango::RigidbodyType::Static;
 }
 
-void Mango::SceneSerializer::EnsureComponentExists(nlohmann::json json, const std::string& componentName)
+void Mango::SceneSerializer::EnsureComponentExists(const nlohmann::json& json, const std::string& componentName)
 {
 	if (!json.contains(componentName))
 	{
@@ -1,20 +1,90 @@
 #pragma once
 
 #include "Scene.h"
+#include "../Infrastructure/IO/JsonStreamWriter.h"
 
 #include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <filesystem>
+#include <istream>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace Mango
 {
 	class SceneSerializer
 	{
 	public:
-		std::string Serialize(Mango::Scene& scene);
-		void Populate(Mango::Scene& scene, std::string& sceneJson);
+		// Entities are written straight into stream one by one, scene is never built as a whole JSON document
+		void Serialize(Mango::Scene& scene, std::ostream& stream);
+		// Entities are created as their tokens arrive, only the entity being parsed is kept as JSON.
+		// Progress is estimated from position in stream of specified size
+		void Populate(Mango::Scene& scene, std::istream& stream, size_t streamSize, std::atomic<float>* progress = nullptr);
+		void Populate(Mango::Scene& scene, std::string& sceneJson, std::atomic<float>* progress = nullptr);
+
+		// Format is chosen by file extension: .mscene files are binary, any other file is JSON.
+		// Jobs are queued on the main thread's queue when submitted from a thread outside job system,
+		// so loads running in background while frames are rendered pass false to decode on their own thread only
+		void PopulateFromFile(Mango::Scene& scene, const std::filesystem::path& filePath, std::atomic<float>* progress = nullptr, bool useJobs = true);
+		void SerializeToFile(Mango::Scene& scene, const std::filesystem::path& filePath);
+		static bool IsBinaryScene(const std::filesystem::path& filePath) { return filePath.extension() == ".mscene"; }
 
 	private:
-		void EnsureComponentExists(nlohmann::json json, const std::string& componentName);
+		// Number of entities decoded into one staging buffer before it's committed into scene
+		static constexpr size_t _chunkSize = 1024;
+
+		// Components of a range of entities decoded without touching registry. Entities are referenced by their row in range.
+		// Rows of sparse components are stored next to their values, so every component is inserted into registry in bulk
+		struct StagedEntities
+		{
+			std::vector<IdComponent> Ids;
+			std::vector<NameComponent> Names;
+			std::vector<TransformComponent> Transforms;
+			std::vector<uint32_t> ColorRows;
+			std::vector<ColorComponent> Colors;
+			std::vector<uint32_t> GeometryRows;
+			std::vector<GeometryComponent> Geometries;
+			std::vector<uint32_t> CameraRows;
+			std::vector<CameraComponent> Cameras;
+			std::vector<uint32_t> RigidbodyRows;
+			std::vector<Mango::RigidbodyType> RigidbodyTypes;
+			std::vector<uint32_t> ScriptRows;
+			std::vector<ScriptComponent> Scripts;
+			std::vector<std::pair<uint32_t, Mango::GUID>> Parents;
+
+			inline size_t GetSize() const { return Ids.size(); }
+			void Clear();
+		};
+
+		// Collects tokens of one entity or prefab at a time and hands them over to serializer
+		class SaxHandler;
+
+		void SerializeEntity(Mango::Scene& scene, entt::entity entity, Mango::JsonStreamWriter& writer);
+		void SerializePrefab(const Mango::Prefab& prefab, Mango::JsonStreamWriter& writer);
+		void SerializeTransform(glm::vec3 translation, glm::vec3 rotation, glm::vec3 scale, Mango::JsonStreamWriter& writer);
+
+		// Entity array is split into chunks of entities, chunks are parsed and decoded on all job system threads.
+		// Only a few chunks ahead of the committed one are decoded at a time, so the scene isn't staged as a whole
+		void PopulateParallel(Mango::Scene& scene, std::string_view sceneJson, std::atomic<float>* progress);
+		// Finds text of every entity and of other scene sections without parsing their values
+		static void SplitScene(std::string_view sceneJson, std::vector<std::string_view>& entities, std::string_view& prefabs, std::string_view& world);
+		static size_t SkipWhitespace(std::string_view json, size_t position);
+		// Returns position right after JSON value starting at position
+		static size_t SkipValue(std::string_view json, size_t position);
+
+		// Safe to call on any thread, entity is appended to staged entities
+		void DecodeEntity(const nlohmann::json& entityJson, StagedEntities& staged);
+		// Creates staged entities in registry and physics world. Parents are linked once all entities exist,
+		// entity and GUID of its parent are appended to parents
+		void CommitEntities(Mango::Scene& scene, StagedEntities& staged, std::vector<std::pair<entt::entity, Mango::GUID>>& parents);
+		void LinkParents(Mango::Scene& scene, const std::vector<std::pair<entt::entity, Mango::GUID>>& parents);
+		Mango::Prefab PopulatePrefab(const nlohmann::json& prefabJson);
+		// Scenes saved before kinematic bodies only have "isDynamic" flag
+		static Mango::RigidbodyType ReadRigidbodyType(const nlohmann::json& rigidbodyJson);
+		void EnsureComponentExists(const nlohmann::json& json, const std::string& componentName);
 	};
 }
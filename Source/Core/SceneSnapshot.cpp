@@ -0,0 +1,53 @@
+#include "SceneSnapshot.h"
+
+#include "Components/Components.h"
+
+#include <entt/entity/snapshot.hpp>
+
+void Mango::SceneSnapshot::Capture(Mango::Scene& scene)
+{
+	_data.clear();
+	Mango::SnapshotOutputArchive archive(_data);
+	entt::snapshot snapshot{ scene._registry };
+	snapshot
+		.entities(archive)
+		.component<IdComponent, NameComponent, TransformComponent, ColorComponent, GeometryComponent, CameraComponent, RigidbodyComponent, ScriptComponent, RelationshipComponent, ChunkComponent>(archive);
+
+	_prefabs = scene.GetPrefabs();
+}
+
+void Mango::SceneSnapshot::Restore(Mango::Scene& scene)
+{
+	if (_data.empty())
+	{
+		return;
+	}
+
+	// Loader requires an empty registry. Scene indices are rebuilt by registry signals while components are loaded
+	scene.ClearEntities();
+	Mango::SnapshotInputArchive archive(_data, scene._physicsWorld);
+	entt::snapshot_loader loader{ scene._registry };
+	loader
+		.entities(archive)
+		.component<IdComponent, NameComponent, TransformComponent, ColorComponent, GeometryComponent, CameraComponent, RigidbodyComponent, ScriptComponent, RelationshipComponent, ChunkComponent>(archive);
+
+	scene._prefabs = _prefabs;
+
+	// Transforms are copied as they were captured, so they are attached to dirty transforms list of restored scene again
+	for (auto [entity, transform] : scene._registry.view<TransformComponent>().each())
+	{
+		transform.AttachDirtyList(&scene._dirtyTransforms, entity);
+	}
+
+	// Streamed chunks could have been loaded or unloaded since capture
+	if (scene._worldStreamer != nullptr)
+	{
+		scene._worldStreamer->SyncLoadedChunks();
+	}
+}
+
+void Mango::SceneSnapshot::Clear()
+{
+	_data.clear();
+	_prefabs.clear();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Scene.h"
+#include "Prefab.h"
+#include "StringPool.h"
+
+#include <entt/entity/registry.hpp>
+#include <box2d/box2d.h>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Mango
+{
+	// Writes snapshot values into a byte buffer. Components are copied as is, physics bodies are written as their full state
+	class SnapshotOutputArchive
+	{
+	public:
+		SnapshotOutputArchive(std::vector<uint8_t>& data) : _data(data) {}
+
+		template<typename Type>
+		void operator()(const Type& value)
+		{
+			static_assert(std::is_trivially_copyable_v<Type>, "Snapshot component must be trivially copyable or have its own overload");
+			const size_t offset = _data.size();
+			_data.resize(offset + sizeof(Type));
+			memcpy(_data.data() + offset, &value, sizeof(Type));
+		}
+
+		void operator()(const Mango::RigidbodyComponent& rigidbody) { (*this)(rigidbody.GetState()); }
+
+		template<typename Component>
+		void operator()(entt::entity entity, const Component& component)
+		{
+			(*this)(entity);
+			(*this)(component);
+		}
+
+	private:
+		std::vector<uint8_t>& _data;
+	};
+
+	// Reads values in the same order they were written. Physics bodies are recreated in specified world
+	class SnapshotInputArchive
+	{
+	public:
+		SnapshotInputArchive(const std::vector<uint8_t>& data, b2World& physicsWorld) : _data(data), _physicsWorld(physicsWorld) {}
+
+		template<typename Type>
+		void operator()(Type& value)
+		{
+			static_assert(std::is_trivially_copyable_v<Type>, "Snapshot component must be trivially copyable or have its own overload");
+			memcpy(&value, _data.data() + _offset, sizeof(Type));
+			_offset += sizeof(Type);
+		}
+
+		void operator()(Mango::RigidbodyComponent& rigidbody)
+		{
+			Mango::RigidbodyState state;
+			(*this)(state);
+			rigidbody.RestoreState(_physicsWorld, state);
+		}
+
+		template<typename Component>
+		void operator()(entt::entity& entity, Component& component)
+		{
+			(*this)(entity);
+			(*this)(component);
+		}
+
+	private:
+		const std::vector<uint8_t>& _data;
+		size_t _offset = 0;
+		b2World& _physicsWorld;
+	};
+
+	// In-memory binary copy of scene entities, physics bodies and prefabs.
+	// Editor captures scene before play and restores it on stop, scene itself with its scripting and physics is kept alive
+	class SceneSnapshot
+	{
+	public:
+		SceneSnapshot() = default;
+		SceneSnapshot(const SceneSnapshot&) = delete;
+		SceneSnapshot operator=(const SceneSnapshot&) = delete;
+
+		void Capture(Mango::Scene& scene);
+		// Replaces all entities of scene with captured ones, restored entities keep their identifiers
+		void Restore(Mango::Scene& scene);
+		void Clear();
+
+		inline bool IsEmpty() const { return _data.empty(); }
+
+	private:
+		std::vector<uint8_t> _data;
+		std::unordered_map<Mango::StringHandle, Mango::Prefab> _prefabs;
+	};
+}
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <unordered_set>
 
 Mango::ScriptEngine::ScriptEngine()
 {
@@ -29,6 +30,10 @@ Mango::ScriptEngine::ScriptEngine()
         throw std::runtime_error("Unable to import MangoEngine python module");
     }
     // Py_DecRef(engineModule);
+
+    _onCollisionBeginName = PyUnicode_InternFromString("OnCollisionBegin");
+    _onCollisionEndName = PyUnicode_InternFromString("OnCollisionEnd");
+    _onCollisionsName = PyUnicode_InternFromString("OnCollisions");
 }
 
 Mango::ScriptEngine::~ScriptEngine()
@@ -43,6 +48,10 @@ Mango::ScriptEngine::~ScriptEngine()
         Py_DecRef(it->second);
     }
 
+    Py_DecRef(_onCollisionBeginName);
+    Py_DecRef(_onCollisionEndName);
+    Py_DecRef(_onCollisionsName);
+
     if (Py_FinalizeEx() < 0)
     {
         PyErr_Print();
@@ -53,66 +62,138 @@ void Mango::ScriptEngine::LoadScripts(std::unordered_map<Mango::GUID, std::files
 {
     // NOTE: Entities not freed here because Python interpreter will crash after some reloads
     _entities.clear();
+    _pendingScripts.clear();
+    _collisionHandlers.clear();
+    _collisionCalls.clear();
+
+    // Modules are reloaded once per play session, entities sharing a script reuse the same module
+    std::unordered_set<std::string> reloadedModules;
 
     // Iterate over all scripts from engine editor
     for (auto it = entitiesToScriptsMap.begin(); it != entitiesToScriptsMap.end(); it++)
     {
         const std::string scriptName = it->second.stem().string();
-        PyObject* module = nullptr;
-        
-        if (_loadedModules.contains(scriptName))
+        if (!reloadedModules.contains(scriptName))
         {
-            // NOTE: This reimport is probably leaking memory and I have no clue how to fix this. Seems like it lies deep inside Python itself.
-            Py_DecRef(_loadedModules[scriptName]);
-            module = PyImport_ReloadModule(_loadedModules[scriptName]);
+            LoadModule(scriptName);
+            reloadedModules.insert(scriptName);
         }
-        else
+
+        PyObject* entity = CreateScriptInstance(it->first, _loadedModules[scriptName]);
+        if (entity != nullptr)
+        {
+            _entities[it->first] = entity;
+            AddCollisionHandlers(it->first, entity);
+        }
+    }
+}
+
+void Mango::ScriptEngine::AttachScript(Mango::GUID entityId, const std::filesystem::path& scriptPath)
+{
+    _pendingScripts.emplace_back(entityId, scriptPath);
+}
+
+void Mango::ScriptEngine::LoadModule(const std::string& scriptName)
+{
+    PyObject* module = nullptr;
+    if (_loadedModules.contains(scriptName))
+    {
+        // NOTE: This reimport is probably leaking memory and I have no clue how to fix this. Seems like it lies deep inside Python itself.
+        Py_DecRef(_loadedModules[scriptName]);
+        module = PyImport_ReloadModule(_loadedModules[scriptName]);
+    }
+    else
+    {
+        module = PyImport_ImportModule(scriptName.c_str());
+    }
+    if (module == nullptr)
+    {
+        PyErr_Print();
+        M_ERROR("Unable to load Python script: " + scriptName);
+    }
+    _loadedModules[scriptName] = module;
+}
+
+PyObject* Mango::ScriptEngine::CreateScriptInstance(Mango::GUID entityId, PyObject* module)
+{
+    if (module == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Scan module
+    PyObject* instance = nullptr;
+    PyObject* moduleClasses = PyModule_GetDict(module);
+    PyObject* key, * value;
+    Py_ssize_t position = 0;
+    // Iterate over all entries in module
+    while (PyDict_Next(moduleClasses, &position, &key, &value))
+    {
+        // Make sure that we can call this object
+        if (!PyCallable_Check(value))
         {
-            module = PyImport_ImportModule(scriptName.c_str());
+            continue;
         }
-        if (module == nullptr)
+
+        // Skip all classes that don't inherit from base MangoEngine.Entity class
+        if (!PyObject_IsSubclass(value, Mango::Scripting::GetEntityType()))
         {
-            PyErr_Print();
-            M_ERROR("Unable to load Python script: " + scriptName);
+            continue;
         }
-        _loadedModules[scriptName] = module;
-
-        // Scan module
-        PyObject* moduleClasses = PyModule_GetDict(module);
-        PyObject* key, * value;
-        Py_ssize_t position = 0;
-        // Iterate over all entries in module
-        while (PyDict_Next(moduleClasses, &position, &key, &value))
+
+        // Skip all functions that aren't bound by a class
+        if (PyFunction_Check(value))
         {
-            // Make sure that we can call this object
-            if (!PyCallable_Check(value))
-            {
-                continue;
-            }
+            continue;
+        }
 
-            // Skip all classes that don't inherit from base MangoEngine.Entity class
-            if (!PyObject_IsSubclass(value, Mango::Scripting::GetEntityType()))
-            {
-                continue;
-            }
+        // Create PyEnities
+        PyObject* pyEntityId = PyLong_FromUnsignedLongLong((uint64_t)entityId);
+        PyObject* args = PyTuple_Pack(1, pyEntityId);
+        instance = PyObject_CallObject(value, args);
+        Py_DecRef(args);
+        Py_DecRef(pyEntityId);
+    }
+    return instance;
+}
 
-            // Skip all functions that aren't bound by a class
-            if (PyFunction_Check(value))
-            {
-                continue;
-            }
+void Mango::ScriptEngine::CreatePendingScripts()
+{
+    if (_pendingScripts.empty())
+    {
+        return;
+    }
 
-            // Create PyEnities
-            PyObject* entityId = PyLong_FromUnsignedLongLong((uint64_t)it->first);
-            PyObject* args = PyTuple_Pack(1, entityId);
-            PyObject* obj = PyObject_CallObject(value, args);
-            _entities[it->first] = obj;
-            Py_DecRef(args);
-            Py_DecRef(entityId);
+    // Entities created by scripts during previous update are registered before iteration starts
+    _createdScripts.clear();
+    for (auto& [entityId, scriptPath] : _pendingScripts)
+    {
+        const std::string scriptName = scriptPath.stem().string();
+        if (!_loadedModules.contains(scriptName))
+        {
+            LoadModule(scriptName);
+        }
+
+        PyObject* entity = CreateScriptInstance(entityId, _loadedModules[scriptName]);
+        if (entity == nullptr)
+        {
+            continue;
         }
-        Py_DecRef(key);
-        Py_DecRef(value);
-        Py_DecRef(moduleClasses);
+
+        // Script could be attached to the same entity again
+        if (_entities.contains(entityId))
+        {
+            Py_DecRef(_entities[entityId]);
+        }
+        _entities[entityId] = entity;
+        AddCollisionHandlers(entityId, entity);
+        _createdScripts.push_back(entity);
+    }
+    _pendingScripts.clear();
+
+    for (auto entity : _createdScripts)
+    {
+        CallMethod(entity, "OnCreate");
     }
 }
 
@@ -132,14 +213,7 @@ void Mango::ScriptEngine::OnCreate()
 
 void Mango::ScriptEngine::OnUpdate()
 {
-    if (!_markedForDeletionEntities.empty())
-    {
-        for (auto& entityId : _markedForDeletionEntities)
-        {
-            DeletePyEntity(entityId);
-        }
-        _markedForDeletionEntities.clear();
-    }
+    CreatePendingScripts();
 
     for (auto& [_, entity] : _entities)
     {
@@ -149,72 +223,159 @@ void Mango::ScriptEngine::OnUpdate()
 
 void Mango::ScriptEngine::OnFixedUpdate()
 {
-    if (!_markedForDeletionEntities.empty())
-    {
-        for (auto& entityId : _markedForDeletionEntities)
-        {
-            DeletePyEntity(entityId);
-        }
-        _markedForDeletionEntities.clear();
-    }
+    CreatePendingScripts();
 
     for (auto& [_, entity] : _entities)
     {
         CallMethod(entity, "OnFixedUpdate");
     }
 
-    CallOnCollisionBegin();
-    CallOnCollisionEnd();
+    CallCollisions();
 }
 
-void Mango::ScriptEngine::OnCollisionBegin(Mango::GUID first, Mango::GUID second)
+void Mango::ScriptEngine::OnCollisions(const std::vector<Mango::CollisionEvent>& events)
 {
-    // Entity could not exist here, because we don't create instances for entities without ScriptComponent
-    // Just create new MangoEngine.Entity and pass it to method. This will enable proper lifecycle of this object
-    if (!_entities.contains(first))
+    // Every side of contact that handles collisions gets its own call with the other side
+    for (const auto& event : events)
     {
-        auto entity = PyObject_New(Mango::Scripting::PyEntity, Mango::Scripting::GetEntityTypeRaw());
-        entity->objPtr = new Mango::Scripting::ScriptableEntity();
-        entity->objPtr->_id = first;
-        _entities[first] = (PyObject*)entity;
+        if (_collisionHandlers.contains(event.FirstId))
+        {
+            _collisionCalls.push_back({ event.FirstId, event.SecondId, event.IsBegin });
+        }
+        if (_collisionHandlers.contains(event.SecondId))
+        {
+            _collisionCalls.push_back({ event.SecondId, event.FirstId, event.IsBegin });
+        }
     }
-    if (!_entities.contains(second))
+}
+
+void Mango::ScriptEngine::AddCollisionHandlers(Mango::GUID entityId, PyObject* entity)
+{
+    uint8_t handlers = 0;
+    if (IsMethodOverridden(entity, _onCollisionBeginName))
     {
-        auto entity = PyObject_New(Mango::Scripting::PyEntity, Mango::Scripting::GetEntityTypeRaw());
-        entity->objPtr = new Mango::Scripting::ScriptableEntity();
-        entity->objPtr->_id = second;
-        _entities[second] = (PyObject*)entity;
+        handlers |= CollisionBeginHandler;
+    }
+    if (IsMethodOverridden(entity, _onCollisionEndName))
+    {
+        handlers |= CollisionEndHandler;
+    }
+    if (IsMethodOverridden(entity, _onCollisionsName))
+    {
+        handlers |= CollisionsBatchHandler;
     }
 
-    _onCollisionBeginCallList.push_back(std::make_pair(first, second));
+    if (handlers != 0)
+    {
+        _collisionHandlers[entityId] = handlers;
+    }
+    else
+    {
+        _collisionHandlers.erase(entityId);
+    }
 }
 
-void Mango::ScriptEngine::OnCollisionEnd(Mango::GUID first, Mango::GUID second)
+bool Mango::ScriptEngine::IsMethodOverridden(PyObject* entity, PyObject* methodName)
 {
-    // All entities should always exist in ScriptEngine at this point
-    _onCollisionEndCallList.push_back(std::make_pair(first, second));
+    // Base MangoEngine.Entity defines every callback as a no-op, subclass overrides it with its own function
+    PyObject* method = PyObject_GetAttr((PyObject*)Py_TYPE(entity), methodName);
+    PyObject* baseMethod = PyObject_GetAttr(Mango::Scripting::GetEntityType(), methodName);
+    bool isOverridden = method != nullptr && method != baseMethod;
+    Py_XDECREF(method);
+    Py_XDECREF(baseMethod);
+    PyErr_Clear();
+    return isOverridden;
 }
 
-void Mango::ScriptEngine::CallOnCollisionBegin()
+void Mango::ScriptEngine::CallCollisions()
 {
-    for (auto& [first, second] : _onCollisionBeginCallList)
+    if (_collisionCalls.empty())
+    {
+        return;
+    }
+
+    // Calls of every entity keep order they were reported in, contact reported again right away is delivered once
+    std::stable_sort(_collisionCalls.begin(), _collisionCalls.end(), [](const CollisionCall& lhs, const CollisionCall& rhs) { return lhs.Receiver < rhs.Receiver; });
+    auto isSameCall = [](const CollisionCall& lhs, const CollisionCall& rhs)
+    {
+        return lhs.Receiver == rhs.Receiver && lhs.Other == rhs.Other && lhs.IsBegin == rhs.IsBegin;
+    };
+    _collisionCalls.erase(std::unique(_collisionCalls.begin(), _collisionCalls.end(), isSameCall), _collisionCalls.end());
+
+    for (size_t begin = 0; begin < _collisionCalls.size();)
+    {
+        const Mango::GUID receiver = _collisionCalls[begin].Receiver;
+        size_t end = begin;
+        while (end < _collisionCalls.size() && _collisionCalls[end].Receiver == receiver)
+        {
+            end++;
+        }
+
+        auto entity = _entities.find(receiver);
+        auto handlers = _collisionHandlers.find(receiver);
+        if (entity == _entities.end() || handlers == _collisionHandlers.end())
+        {
+            begin = end;
+            continue;
+        }
+
+        if (handlers->second & CollisionsBatchHandler)
+        {
+            PyObject* begun = PyList_New(0);
+            PyObject* ended = PyList_New(0);
+            for (size_t i = begin; i < end; i++)
+            {
+                PyList_Append(_collisionCalls[i].IsBegin ? begun : ended, GetCollisionEntity(_collisionCalls[i].Other));
+            }
+            PyObject* result = PyObject_CallMethodObjArgs(entity->second, _onCollisionsName, begun, ended, nullptr);
+            if (result == nullptr)
+            {
+                PyErr_Print();
+            }
+            Py_XDECREF(result);
+            Py_DecRef(begun);
+            Py_DecRef(ended);
+        }
+        else
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto& call = _collisionCalls[i];
+                const uint8_t handler = call.IsBegin ? CollisionBeginHandler : CollisionEndHandler;
+                if (handlers->second & handler)
+                {
+                    CallMethod(entity->second, GetCollisionEntity(call.Other), call.IsBegin ? _onCollisionBeginName : _onCollisionEndName);
+                }
+            }
+        }
+        begin = end;
+    }
+    _collisionCalls.clear();
+
+    for (auto& [_, proxy] : _collisionProxies)
     {
-        PyObject* firstEntity = _entities[first];
-        PyObject* secondEntity = _entities[second];
-        CallMethod(firstEntity, secondEntity, "OnCollisionBegin");
+        Py_DecRef(proxy);
     }
-    _onCollisionBeginCallList.clear();
+    _collisionProxies.clear();
 }
 
-void Mango::ScriptEngine::CallOnCollisionEnd()
+PyObject* Mango::ScriptEngine::GetCollisionEntity(Mango::GUID entityId)
 {
-    for (auto& [first, second] : _onCollisionEndCallList)
+    auto entity = _entities.find(entityId);
+    if (entity != _entities.end())
+    {
+        return entity->second;
+    }
+
+    auto& proxy = _collisionProxies[entityId];
+    if (proxy == nullptr)
     {
-        PyObject* firstEntity = _entities[first];
-        PyObject* secondEntity = _entities[second];
-        CallMethod(firstEntity, secondEntity, "OnCollisionEnd");
+        auto proxyEntity = PyObject_New(Mango::Scripting::PyEntity, Mango::Scripting::GetEntityTypeRaw());
+        proxyEntity->objPtr = new Mango::Scripting::ScriptableEntity();
+        proxyEntity->objPtr->_id = entityId;
+        proxy = (PyObject*)proxyEntity;
     }
-    _onCollisionEndCallList.clear();
+    return proxy;
 }
 
 void Mango::ScriptEngine::CallMethod(PyObject* entity, std::string methodName)
@@ -231,11 +392,50 @@ void Mango::ScriptEngine::CallMethod(PyObject* entity, PyObject* args, std::stri
     Py_DecRef(method);
 }
 
+void Mango::ScriptEngine::CallMethod(PyObject* entity, PyObject* args, PyObject* methodName)
+{
+    PyObject* result = PyObject_CallMethodOneArg(entity, methodName, args);
+    if (result == nullptr)
+    {
+        PyErr_Print();
+    }
+    Py_XDECREF(result);
+}
+
+void Mango::ScriptEngine::OnEntitiesDestroyed(const std::vector<Mango::GUID>& entityIds)
+{
+    if (entityIds.empty())
+    {
+        return;
+    }
+
+    for (auto entityId : entityIds)
+    {
+        DeletePyEntity(entityId);
+    }
+
+    // Collision callbacks of destroyed entities can't be delivered anymore
+    std::unordered_set<uint64_t> destroyed(entityIds.begin(), entityIds.end());
+    std::erase_if(_collisionCalls, [&destroyed](const CollisionCall& call)
+    {
+        return destroyed.contains(call.Receiver) || destroyed.contains(call.Other);
+    });
+}
+
 void Mango::ScriptEngine::DeletePyEntity(Mango::GUID entityId)
 {
-    PyObject* entity = _entities[entityId];
-    Py_DecRef(entity);
-    _entities.erase(entityId);
+    // Entity could be destroyed before its script instance was created
+    std::erase_if(_pendingScripts, [entityId](const auto& pendingScript) { return pendingScript.first == entityId; });
+
+    _collisionHandlers.erase(entityId);
+    auto it = _entities.find(entityId);
+    if (it == _entities.end())
+    {
+        return;
+    }
+
+    Py_DecRef(it->second);
+    _entities.erase(it);
 }
 
 PyObject* Mango::ScriptEngine::HandleScriptEvent(Mango::Scripting::ScriptEvent event)
@@ -297,10 +497,34 @@ PyObject* Mango::ScriptEngine::HandleScriptEvent(Mango::Scripting::ScriptEvent e
     {
         return scriptEngine->HandleConfigureRigidbodyEvent(event.ScriptableEntity, event.Args);
     }
+    else if (event.EventName == "SetVelocity")
+    {
+        return scriptEngine->HandleSetVelocityEvent(event.ScriptableEntity, event.Args);
+    }
     else if (event.EventName == "FindEntityByName")
     {
         return scriptEngine->HandleFindEntityByNameEvent(event.Args);
     }
+    else if (event.EventName == "InstantiatePrefab")
+    {
+        return scriptEngine->HandleInstantiatePrefabEvent(event.Args);
+    }
+    else if (event.EventName == "SetParent")
+    {
+        return scriptEngine->HandleSetParentEvent(event.ScriptableEntity, event.Args);
+    }
+    else if (event.EventName == "GetDeltaTime")
+    {
+        return scriptEngine->HandleGetTimeEvent(scriptEngine->_getDeltaTimeEventHandler);
+    }
+    else if (event.EventName == "GetFixedDeltaTime")
+    {
+        return scriptEngine->HandleGetTimeEvent(scriptEngine->_getFixedDeltaTimeEventHandler);
+    }
+    else if (event.EventName == "GetInterpolationAlpha")
+    {
+        return scriptEngine->HandleGetTimeEvent(scriptEngine->_getInterpolationAlphaEventHandler);
+    }
     Py_IncRef(Py_None);
     return Py_None;
 }
@@ -414,15 +638,10 @@ PyObject* Mango::ScriptEngine::HandleDestroyEntityEvent(PyObject* args)
         return Py_None;
     }
 
+    // Entity is recorded for destruction, its instance is released once scene plays back its commands
     auto scriptableEntity = (Mango::Scripting::PyEntity*)entity;
     Mango::GUID entityId(scriptableEntity->objPtr->_id);
-    if (std::find(_markedForDeletionEntities.begin(), _markedForDeletionEntities.end(), entityId) != _markedForDeletionEntities.end())
-    {
-        return Py_None;
-    }
-
     _destroyEntityEventHandler(this, entityId);
-    _markedForDeletionEntities.push_back(entityId);
     return Py_None;
 }
 
@@ -440,31 +659,122 @@ PyObject* Mango::ScriptEngine::HandleConfigureRigidbodyEvent(Mango::Scripting::S
     Mango::GUID entityId(entity->_id);
     PyObject* pyDensity = PyTuple_GetItem(args, 0);
     PyObject* pyFriction = PyTuple_GetItem(args, 1);
-    PyObject* pyDynamic = PyTuple_GetItem(args, 2);
+    PyObject* pyBodyType = PyTuple_GetItem(args, 2);
     float density = PyFloat_AsDouble(pyDensity);
     float friction = PyFloat_AsDouble(pyFriction);
-    bool dynamic = Py_IsTrue(pyDynamic);
-    _configureRigidbodyEventHandler(this, entityId, density, friction, dynamic);
+    // Boolean is still accepted for dynamic or static body
+    Mango::RigidbodyType bodyType = Mango::RigidbodyType::Static;
+    if (PyBool_Check(pyBodyType))
+    {
+        bodyType = Py_IsTrue(pyBodyType) ? Mango::RigidbodyType::Dynamic : Mango::RigidbodyType::Static;
+    }
+    else
+    {
+        long bodyTypeValue = PyLong_AsLong(pyBodyType);
+        if (PyErr_Occurred() || bodyTypeValue < 0 || bodyTypeValue > static_cast<long>(Mango::RigidbodyType::Kinematic))
+        {
+            PyErr_Clear();
+            return Py_None;
+        }
+        bodyType = static_cast<Mango::RigidbodyType>(bodyTypeValue);
+    }
+    _configureRigidbodyEventHandler(this, entityId, density, friction, bodyType);
+    return Py_None;
+}
+
+PyObject* Mango::ScriptEngine::HandleSetVelocityEvent(Mango::Scripting::ScriptableEntity* entity, PyObject* args)
+{
+    Mango::GUID entityId(entity->_id);
+    PyObject* pyX = PyTuple_GetItem(args, 0);
+    PyObject* pyY = PyTuple_GetItem(args, 1);
+    float x = PyFloat_AsDouble(pyX);
+    float y = PyFloat_AsDouble(pyY);
+    _setVelocityEventHandler(this, entityId, glm::vec2(x, y));
     return Py_None;
 }
 
 PyObject* Mango::ScriptEngine::HandleFindEntityByNameEvent(PyObject* args)
 {
     PyObject* pyEntityName = PyTuple_GetItem(args, 0);
-    std::string entityName = PyUnicode_AsUTF8(pyEntityName);
+    Py_ssize_t entityNameSize = 0;
+    const char* entityNameData = PyUnicode_AsUTF8AndSize(pyEntityName, &entityNameSize);
+    if (entityNameData == nullptr)
+    {
+        PyErr_Clear();
+        Py_IncRef(Py_None);
+        return Py_None;
+    }
+
+    std::string_view entityName(entityNameData, static_cast<size_t>(entityNameSize));
     auto entityId = _findEntityByNameEventHandler(this, entityName);
     if (entityId == Mango::GUID::Empty())
     {
+        Py_IncRef(Py_None);
         return Py_None;
     }
 
-    if (!_entities.contains(entityId))
+    // Entity without script gets a new proxy, so it never becomes a script instance updated every frame
+    auto it = _entities.find(entityId);
+    if (it != _entities.end())
+    {
+        Py_IncRef(it->second);
+        return it->second;
+    }
+
+    auto entity = PyObject_New(Mango::Scripting::PyEntity, Mango::Scripting::GetEntityTypeRaw());
+    entity->objPtr = new Mango::Scripting::ScriptableEntity();
+    entity->objPtr->_id = entityId;
+    return (PyObject*)entity;
+}
+
+PyObject* Mango::ScriptEngine::HandleSetParentEvent(Mango::Scripting::ScriptableEntity* entity, PyObject* args)
+{
+    Mango::GUID entityId(entity->_id);
+    PyObject* pyParent = PyTuple_GetItem(args, 0);
+    Mango::GUID parentId(Mango::GUID::Empty());
+    if (PyObject_IsInstance(pyParent, Mango::Scripting::GetEntityType()))
+    {
+        parentId = ((Mango::Scripting::PyEntity*)pyParent)->objPtr->_id;
+    }
+    _setParentEventHandler(this, entityId, parentId);
+    return Py_None;
+}
+
+PyObject* Mango::ScriptEngine::HandleInstantiatePrefabEvent(PyObject* args)
+{
+    PyObject* pyPrefabName = PyTuple_GetItem(args, 0);
+    PyObject* pyCount = PyTuple_GetItem(args, 1);
+    Py_ssize_t prefabNameSize = 0;
+    const char* prefabNameData = PyUnicode_AsUTF8AndSize(pyPrefabName, &prefabNameSize);
+    long long count = PyLong_AsLongLong(pyCount);
+    if (prefabNameData == nullptr || count < 0 || PyErr_Occurred())
+    {
+        PyErr_Clear();
+        return PyList_New(0);
+    }
+
+    _instantiatedEntityIds.clear();
+    std::string_view prefabName(prefabNameData, static_cast<size_t>(prefabNameSize));
+    if (!_instantiatePrefabEventHandler(this, prefabName, static_cast<size_t>(count), _instantiatedEntityIds))
+    {
+        M_ERROR("Unable to find prefab: " + std::string(prefabName));
+        return PyList_New(0);
+    }
+
+    PyObject* entities = PyList_New(static_cast<Py_ssize_t>(_instantiatedEntityIds.size()));
+    for (size_t i = 0; i < _instantiatedEntityIds.size(); i++)
     {
         auto entity = PyObject_New(Mango::Scripting::PyEntity, Mango::Scripting::GetEntityTypeRaw());
         entity->objPtr = new Mango::Scripting::ScriptableEntity();
-        entity->objPtr->_id = entityId;
-        _entities[entityId] = (PyObject*)entity;
+        entity->objPtr->_id = _instantiatedEntityIds[i];
+        // PyList_SetItem steals the reference
+        PyList_SetItem(entities, static_cast<Py_ssize_t>(i), (PyObject*)entity);
     }
+    return entities;
+}
 
-    return _entities[entityId];
+PyObject* Mango::ScriptEngine::HandleGetTimeEvent(GetTimeEventHandler handler)
+{
+    float time = handler(this);
+    return PyFloat_FromDouble(static_cast<double>(time));
 }
@@ -3,12 +3,15 @@
 #include "ScripingLibrary.h"
 #include "../Input.h"
 #include "../GUID.h"
+#include "../RigidbodyType.h"
+#include "../CollisionEvent.h"
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include "glm/glm.hpp"
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <filesystem>
 #include <vector>
@@ -31,20 +34,30 @@ namespace Mango
 		typedef Mango::GUID (*CreateEntityEventHandler)(Mango::ScriptEngine*);
 		typedef void (*DestroyEntityEventHandler)(Mango::ScriptEngine*, Mango::GUID);
 		typedef void (*SetRigidEntityEventHandler)(Mango::ScriptEngine*, Mango::GUID, bool);
-		typedef void (*ConfigureRigidbodyEventHandler)(Mango::ScriptEngine*, Mango::GUID, float, float, bool);
-		typedef Mango::GUID (*FindEntityByNameEventHandler)(Mango::ScriptEngine*, std::string);
+		typedef void (*ConfigureRigidbodyEventHandler)(Mango::ScriptEngine*, Mango::GUID, float, float, Mango::RigidbodyType);
+		typedef void (*SetVelocityEventHandler)(Mango::ScriptEngine*, Mango::GUID, glm::vec2);
+		typedef Mango::GUID (*FindEntityByNameEventHandler)(Mango::ScriptEngine*, std::string_view);
+		typedef void (*SetParentEventHandler)(Mango::ScriptEngine*, Mango::GUID, Mango::GUID);
+		typedef bool (*InstantiatePrefabEventHandler)(Mango::ScriptEngine*, std::string_view, size_t, std::vector<Mango::GUID>&);
+		typedef float (*GetTimeEventHandler)(Mango::ScriptEngine*);
 
 		ScriptEngine();
 		~ScriptEngine();
 
 		void LoadScripts(std::unordered_map<Mango::GUID, std::filesystem::path> entitiesToScriptsMap);
+		// Script instance of entity created during play is created and gets OnCreate call before next update
+		void AttachScript(Mango::GUID entityId, const std::filesystem::path& scriptPath);
 
 		void OnCreate(std::uint64_t entityId);
 		void OnCreate();
 		void OnUpdate();
 		void OnFixedUpdate();
-		void OnCollisionBegin(Mango::GUID first, Mango::GUID second);
-		void OnCollisionEnd(Mango::GUID first, Mango::GUID second);
+		// Entity has script instance that overrides at least one collision callback
+		inline bool HandlesCollisions(Mango::GUID entityId) const { return _collisionHandlers.contains(entityId); }
+		// Contacts of completed step, they are delivered after OnFixedUpdate to every side that handles them
+		void OnCollisions(const std::vector<Mango::CollisionEvent>& events);
+		// Release script instances of entities destroyed at scene sync point
+		void OnEntitiesDestroyed(const std::vector<Mango::GUID>& entityIds);
 
 	public:
 		void SetApplyForceEventHandler(ApplyForceEventHandler handler) { _applyForceHandler = handler; }
@@ -61,7 +74,13 @@ namespace Mango
 		void SetDestroyEntityEventHandler(DestroyEntityEventHandler handler) { _destroyEntityEventHandler = handler; }
 		void SetSetRigidEntityEventHandler(SetRigidEntityEventHandler handler) { _setRigidEntityEventHandler = handler; }
 		void SetConfigureRigidbodyEventHandler(ConfigureRigidbodyEventHandler handler) { _configureRigidbodyEventHandler = handler; }
+		void SetSetVelocityEventHandler(SetVelocityEventHandler handler) { _setVelocityEventHandler = handler; }
 		void SetFindEntityByNameEventHandler(FindEntityByNameEventHandler handler) { _findEntityByNameEventHandler = handler; }
+		void SetSetParentEventHandler(SetParentEventHandler handler) { _setParentEventHandler = handler; }
+		void SetInstantiatePrefabEventHandler(InstantiatePrefabEventHandler handler) { _instantiatePrefabEventHandler = handler; }
+		void SetGetDeltaTimeEventHandler(GetTimeEventHandler handler) { _getDeltaTimeEventHandler = handler; }
+		void SetGetFixedDeltaTimeEventHandler(GetTimeEventHandler handler) { _getFixedDeltaTimeEventHandler = handler; }
+		void SetGetInterpolationAlphaEventHandler(GetTimeEventHandler handler) { _getInterpolationAlphaEventHandler = handler; }
 		
 		void SetUserData(void* data) { _userData = data; }
 		void* GetUserData() { return _userData; }
@@ -69,15 +88,50 @@ namespace Mango
 	private:
 		std::unordered_map<std::string, PyObject*> _loadedModules;
 		std::unordered_map<std::uint64_t, PyObject*> _entities;
-		std::vector<Mango::GUID> _markedForDeletionEntities;
-		std::vector<std::pair<Mango::GUID, Mango::GUID>> _onCollisionBeginCallList;
-		std::vector<std::pair<Mango::GUID, Mango::GUID>> _onCollisionEndCallList;
+		std::vector<std::pair<Mango::GUID, std::filesystem::path>> _pendingScripts;
+		std::vector<PyObject*> _createdScripts;
+		std::vector<Mango::GUID> _instantiatedEntityIds;
 
-		void CallOnCollisionBegin();
-		void CallOnCollisionEnd();
+		// Collision callbacks script instance overrides
+		enum CollisionHandler : uint8_t
+		{
+			CollisionBeginHandler = 1 << 0,
+			CollisionEndHandler = 1 << 1,
+			CollisionsBatchHandler = 1 << 2
+		};
+
+		struct CollisionCall
+		{
+			Mango::GUID Receiver;
+			Mango::GUID Other;
+			bool IsBegin;
+		};
+
+		std::unordered_map<std::uint64_t, uint8_t> _collisionHandlers;
+		std::vector<CollisionCall> _collisionCalls;
+		// Entities without script instances are passed to callbacks as proxies that live for one delivery only
+		std::unordered_map<std::uint64_t, PyObject*> _collisionProxies;
+		// Interned names of collision callbacks
+		PyObject* _onCollisionBeginName = nullptr;
+		PyObject* _onCollisionEndName = nullptr;
+		PyObject* _onCollisionsName = nullptr;
+
+		void LoadModule(const std::string& scriptName);
+		// Returns instance of MangoEngine.Entity subclass defined in module or nullptr
+		PyObject* CreateScriptInstance(Mango::GUID entityId, PyObject* module);
+		void CreatePendingScripts();
+
+		// Registers collision callbacks overridden by script instance of entity
+		void AddCollisionHandlers(Mango::GUID entityId, PyObject* entity);
+		bool IsMethodOverridden(PyObject* entity, PyObject* methodName);
+		// Calls are grouped by receiving entity, entity that overrides OnCollisions gets all of them in one call
+		void CallCollisions();
+		// Returns borrowed script instance or proxy of entity
+		PyObject* GetCollisionEntity(Mango::GUID entityId);
 
 		void CallMethod(PyObject* entity, std::string methodName);
 		void CallMethod(PyObject* entity, PyObject* args, std::string methodName);
+		void CallMethod(PyObject* entity, PyObject* args, PyObject* methodName);
 		void DeletePyEntity(Mango::GUID entityId);
 		static PyObject* HandleScriptEvent(Mango::Scripting::ScriptEvent event);
 
@@ -95,7 +149,11 @@ namespace Mango
 		PyObject* HandleDestroyEntityEvent(PyObject* args);
 		PyObject* HandleSetRigidEntityEvent(Mango::Scripting::ScriptableEntity* entity, PyObject* args);
 		PyObject* HandleConfigureRigidbodyEvent(Mango::Scripting::ScriptableEntity* entity, PyObject* args);
+		PyObject* HandleSetVelocityEvent(Mango::Scripting::ScriptableEntity* entity, PyObject* args);
 		PyObject* HandleFindEntityByNameEvent(PyObject* args);
+		PyObject* HandleSetParentEvent(Mango::Scripting::ScriptableEntity* entity, PyObject* args);
+		PyObject* HandleInstantiatePrefabEvent(PyObject* args);
+		PyObject* HandleGetTimeEvent(GetTimeEventHandler handler);
 
 	private:
 		ApplyForceEventHandler _applyForceHandler;
@@ -112,7 +170,13 @@ namespace Mango
 		DestroyEntityEventHandler _destroyEntityEventHandler;
 		SetRigidEntityEventHandler _setRigidEntityEventHandler;
 		ConfigureRigidbodyEventHandler _configureRigidbodyEventHandler;
+		SetVelocityEventHandler _setVelocityEventHandler;
 		FindEntityByNameEventHandler _findEntityByNameEventHandler;
+		SetParentEventHandler _setParentEventHandler;
+		InstantiatePrefabEventHandler _instantiatePrefabEventHandler;
+		GetTimeEventHandler _getDeltaTimeEventHandler;
+		GetTimeEventHandler _getFixedDeltaTimeEventHandler;
+		GetTimeEventHandler _getInterpolationAlphaEventHandler;
 		void* _userData;
 	};
 }
@@ -30,6 +30,13 @@ static std::unordered_map<std::string, int32_t> _mouseButtonsMapping
     { "Right", 2 }
 };
 
+static std::unordered_map<std::string, int32_t> _bodyTypesMapping
+{
+    { "Static", 0 },
+    { "Dynamic", 1 },
+    { "Kinematic", 2 }
+};
+
 static PyObject* ReturnNone()
 {
     Py_IncRef(Py_None);
@@ -42,6 +49,7 @@ static PyObject* OnUpdate(Mango::Scripting::PyEntity* self, PyObject* Py_UNUSED(
 static PyObject* OnFixedUpdate(Mango::Scripting::PyEntity* self, PyObject* Py_UNUSED(args)) { return ReturnNone(); }
 static PyObject* OnCollisionBegin(Mango::Scripting::PyEntity* self, PyObject* Py_UNUSED(args)) { return ReturnNone(); }
 static PyObject* OnCollisionEnd(Mango::Scripting::PyEntity* self, PyObject* Py_UNUSED(args)) { return ReturnNone(); }
+static PyObject* OnCollisions(Mango::Scripting::PyEntity* self, PyObject* Py_UNUSED(args)) { return ReturnNone(); }
 
 static PyObject* GetId(Mango::Scripting::PyEntity* self, PyObject* Py_UNUSED(args))
 {
@@ -150,6 +158,28 @@ static PyObject* ConfigureRigidbody(Mango::Scripting::PyEntity* self, PyObject*
     return result;
 }
 
+static PyObject* SetVelocity(Mango::Scripting::PyEntity* self, PyObject* args)
+{
+    Mango::Scripting::ScriptEvent event;
+    event.EventName = "SetVelocity";
+    event.ScriptableEntity = self->objPtr;
+    event.Args = args;
+    PyObject* result = _eventHandler(event);
+    Py_IncRef(result);
+    return result;
+}
+
+static PyObject* SetParent(Mango::Scripting::PyEntity* self, PyObject* args)
+{
+    Mango::Scripting::ScriptEvent event;
+    event.EventName = "SetParent";
+    event.ScriptableEntity = self->objPtr;
+    event.Args = args;
+    PyObject* result = _eventHandler(event);
+    Py_IncRef(result);
+    return result;
+}
+
 static PyMethodDef _entityMethods[] =
 {
     {
@@ -192,6 +222,15 @@ static PyMethodDef _entityMethods[] =
          Method signature is: def OnCollisionEnd(self: MangoEntity.Entity, other: MangoEntity.Entity) -> None \
          It is a base method on MangoEngine.Entity. It could be defined on custom entities and will be called by engine."
     },
+    {
+        "OnCollisions",
+        (PyCFunction)OnCollisions,
+        METH_VARARGS,
+        "Method gets executed once per physics tick with all collisions of an object that began and ended during the tick. \
+         If it's defined, OnCollisionBegin and OnCollisionEnd aren't called. \
+         Method signature is: def OnCollisions(self: MangoEntity.Entity, begun: list[MangoEntity.Entity], ended: list[MangoEntity.Entity]) -> None \
+         It is a base method on MangoEngine.Entity. It could be defined on custom entities and will be called by engine."
+    },
     {
         "GetId",
         (PyCFunction)GetId,
@@ -211,6 +250,7 @@ static PyMethodDef _entityMethods[] =
         (PyCFunction)SetPosition,
         METH_VARARGS,
         "Set position of the current entity. \
+         Kinematic rigidbody isn't teleported, it moves to new position during the next physics step. \
          Call example: super().SetPosition(x: float, y: float) -> None"
     },
     {
@@ -225,6 +265,7 @@ static PyMethodDef _entityMethods[] =
         (PyCFunction)SetRotation,
         METH_VARARGS,
         "Set rotation of the current entity in degrees. \
+         Kinematic rigidbody isn't teleported, it turns to new rotation during the next physics step. \
          Call example: super().SetRotation(angleDegress: float) -> None"
     },
     {
@@ -260,7 +301,23 @@ static PyMethodDef _entityMethods[] =
         (PyCFunction)ConfigureRigidbody,
         METH_VARARGS,
         "Configure rigidbody for current entity. \
-         Call example: super().ConfigureRigidbody(density: float, friction: float, dynamic: Boolean) -> None"
+         Body type is one of MangoEngine.BodyTypes, True and False still mean dynamic and static body. \
+         Call example: super().ConfigureRigidbody(density: float, friction: float, bodyType: int) -> None"
+    },
+    {
+        "SetVelocity",
+        (PyCFunction)SetVelocity,
+        METH_VARARGS,
+        "Set linear velocity of current entity's rigidbody. Kinematic rigidbody keeps moving with it until it's changed. \
+         Call example: super().SetVelocity(x: float, y: float) -> None"
+    },
+    {
+        "SetParent",
+        (PyCFunction)SetParent,
+        METH_VARARGS,
+        "Attach current entity to parent entity, pass None to detach it. \
+         Position, rotation and scale of attached entity become relative to its parent. \
+         Call example: super().SetParent(parent: MangoEngine.Entity | None) -> None"
     },
     { nullptr, nullptr, 0, nullptr } // This line is required, don't remove!
 };
@@ -319,6 +376,23 @@ static PyObject* MouseButtons(Mango::Scripting::PyEntity* Py_UNUSED(self), PyObj
     return noneButton;
 }
 
+static PyObject* BodyTypes(Mango::Scripting::PyEntity* Py_UNUSED(self), PyObject* args)
+{
+    PyObject* pyBodyType = PyTuple_GetItem(args, 0);
+    std::string bodyTypeName = PyUnicode_AsUTF8(pyBodyType);
+    if (_bodyTypesMapping.contains(bodyTypeName))
+    {
+        PyObject* bodyTypeInt = PyLong_FromLong(_bodyTypesMapping[bodyTypeName]);
+        Py_IncRef(bodyTypeInt);
+        return bodyTypeInt;
+    }
+
+    // Unknown body type makes body dynamic
+    PyObject* dynamicBodyType = PyLong_FromLong(_bodyTypesMapping["Dynamic"]);
+    Py_IncRef(dynamicBodyType);
+    return dynamicBodyType;
+}
+
 static PyObject* GetCursorPosition(Mango::Scripting::PyEntity* Py_UNUSED(self), PyObject* args)
 {
     Mango::Scripting::ScriptEvent event;
@@ -358,9 +432,48 @@ static PyObject* FindEntityByName(Mango::Scripting::PyEntity* Py_UNUSED(self), P
     event.EventName = "FindEntityByName";
     event.ScriptableEntity = nullptr;
     event.Args = args;
-    PyObject* result = _eventHandler(event);
-    Py_IncRef(result);
-    return result;
+    // Returned entity is a new reference already
+    return _eventHandler(event);
+}
+
+static PyObject* InstantiatePrefab(Mango::Scripting::PyEntity* Py_UNUSED(self), PyObject* args)
+{
+    Mango::Scripting::ScriptEvent event;
+    event.EventName = "InstantiatePrefab";
+    event.ScriptableEntity = nullptr;
+    event.Args = args;
+    // Returned list is a new reference already
+    return _eventHandler(event);
+}
+
+static PyObject* GetDeltaTime(Mango::Scripting::PyEntity* Py_UNUSED(self), PyObject* Py_UNUSED(args))
+{
+    Mango::Scripting::ScriptEvent event;
+    event.EventName = "GetDeltaTime";
+    event.ScriptableEntity = nullptr;
+    event.Args = nullptr;
+    // Returned float is a new reference already
+    return _eventHandler(event);
+}
+
+static PyObject* GetFixedDeltaTime(Mango::Scripting::PyEntity* Py_UNUSED(self), PyObject* Py_UNUSED(args))
+{
+    Mango::Scripting::ScriptEvent event;
+    event.EventName = "GetFixedDeltaTime";
+    event.ScriptableEntity = nullptr;
+    event.Args = nullptr;
+    // Returned float is a new reference already
+    return _eventHandler(event);
+}
+
+static PyObject* GetInterpolationAlpha(Mango::Scripting::PyEntity* Py_UNUSED(self), PyObject* Py_UNUSED(args))
+{
+    Mango::Scripting::ScriptEvent event;
+    event.EventName = "GetInterpolationAlpha";
+    event.ScriptableEntity = nullptr;
+    event.Args = nullptr;
+    // Returned float is a new reference already
+    return _eventHandler(event);
 }
 
 static PyMethodDef _moduleMethods[]
@@ -397,6 +510,15 @@ static PyMethodDef _moduleMethods[]
          If provided key doesn't exist method will return not existing key. \
          Call example: MangoEngine.MouseButtons(mouseButtonName: str) -> int"
     },
+    {
+        "BodyTypes",
+        (PyCFunction)BodyTypes,
+        METH_VARARGS,
+        "Get rigidbody type for specified body type string. \
+         Available arguments: [ Static, Dynamic, Kinematic ] \
+         If provided body type doesn't exist method will return dynamic body type. \
+         Call example: MangoEngine.BodyTypes(bodyTypeName: str) -> int"
+    },
     {
         "GetCursorPosition",
         (PyCFunction)GetCursorPosition,
@@ -423,10 +545,41 @@ static PyMethodDef _moduleMethods[]
         (PyCFunction)FindEntityByName,
         METH_VARARGS,
         "Find entity by specified name. \
-         If multiple entities has the same name method will return first one according to Entities panel. \
+         If multiple entities has the same name method will return the one that got this name first. \
          If entity with specified name doesn't exist method will return None. \
          Call example: MangoEngine.FindEntityByName(entityName: str) -> MangoEngine.Entity"
     },
+    {
+        "InstantiatePrefab",
+        (PyCFunction)InstantiatePrefab,
+        METH_VARARGS,
+        "Create count entities from prefab with specified name at once and return all of them. \
+         Scripts of new entities get OnCreate call before next update. \
+         If prefab with specified name doesn't exist method will return empty list. \
+         Call example: MangoEngine.InstantiatePrefab(prefabName: str, count: int) -> list[MangoEngine.Entity]"
+    },
+    {
+        "GetDeltaTime",
+        (PyCFunction)GetDeltaTime,
+        METH_NOARGS,
+        "Get time in seconds passed since previous frame. Inside OnFixedUpdate returns fixed time step. \
+         Call example: MangoEngine.GetDeltaTime() -> float"
+    },
+    {
+        "GetFixedDeltaTime",
+        (PyCFunction)GetFixedDeltaTime,
+        METH_NOARGS,
+        "Get fixed time step in seconds used by physics and OnFixedUpdate. \
+         Call example: MangoEngine.GetFixedDeltaTime() -> float"
+    },
+    {
+        "GetInterpolationAlpha",
+        (PyCFunction)GetInterpolationAlpha,
+        METH_NOARGS,
+        "Get fraction of fixed time step passed since the last fixed update, from 0 to 1. \
+         Rigidbodies are rendered interpolated by this value between their last two physics poses. \
+         Call example: MangoEngine.GetInterpolationAlpha() -> float"
+    },
     { nullptr, nullptr, 0, nullptr } // This line is required, don't remove!
 };
 
@@ -0,0 +1,41 @@
+#include "ShapeCache.h"
+
+#include <functional>
+
+const b2PolygonShape& Mango::ShapeCache::GetShape(Mango::GeometryType geometry, glm::vec2 scale)
+{
+	// Mirrored geometry collides the same way, degenerate shapes aren't accepted by Box2D
+	scale = glm::max(glm::abs(scale), glm::vec2(b2_linearSlop));
+	const ShapeKey key{ geometry, scale };
+	auto it = _shapes.find(key);
+	if (it != _shapes.end())
+	{
+		return it->second;
+	}
+
+	if (_shapes.size() >= _maxShapesCount)
+	{
+		_shapes.clear();
+	}
+
+	b2PolygonShape shape;
+	if (geometry == Mango::GeometryType::Triangle)
+	{
+		const b2Vec2 vertices[] = { { -scale.x, -scale.y }, { 0.0f, scale.y }, { scale.x, -scale.y } };
+		shape.Set(vertices, 3);
+	}
+	else
+	{
+		shape.SetAsBox(scale.x, scale.y);
+	}
+	return _shapes.emplace(key, shape).first->second;
+}
+
+size_t Mango::ShapeCache::ShapeKeyHash::operator()(const ShapeKey& key) const
+{
+	std::hash<float> hash;
+	size_t result = static_cast<size_t>(key.Geometry);
+	result = result * 31 + hash(key.Scale.x);
+	result = result * 31 + hash(key.Scale.y);
+	return result;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GeometryType.h"
+
+#include <glm/glm.hpp>
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace Mango
+{
+	// Collision shapes of entity geometry at specific scale. Box2D copies shape into every fixture created from it,
+	// so one cached shape is shared by all bodies of the same geometry and scale
+	class ShapeCache
+	{
+	public:
+		ShapeCache() = default;
+		ShapeCache(const ShapeCache&) = delete;
+		ShapeCache operator=(const ShapeCache&) = delete;
+
+		// Shape matches vertices geometry is rendered with
+		const b2PolygonShape& GetShape(Mango::GeometryType geometry, glm::vec2 scale);
+		void Clear() { _shapes.clear(); }
+
+	private:
+		struct ShapeKey
+		{
+			Mango::GeometryType Geometry;
+			glm::vec2 Scale;
+
+			bool operator==(const ShapeKey& other) const { return Geometry == other.Geometry && Scale == other.Scale; }
+		};
+
+		struct ShapeKeyHash
+		{
+			size_t operator()(const ShapeKey& key) const;
+		};
+
+		// Scripts animating scale could produce any number of distinct scales, so cache is dropped once it grows this big
+		static constexpr size_t _maxShapesCount = 4096;
+		std::unordered_map<ShapeKey, b2PolygonShape, ShapeKeyHash> _shapes;
+	};
+}
@@ -0,0 +1,90 @@
+#include "StringPool.h"
+
+#include "../Infrastructure/Assert/Assert.h"
+
+#include <cstring>
+
+std::mutex Mango::StringPool::_mutex;
+std::vector<std::unique_ptr<char[]>> Mango::StringPool::_blocks;
+char* Mango::StringPool::_currentBlock = nullptr;
+size_t Mango::StringPool::_blockOffset = Mango::StringPool::BlockSize;
+std::vector<std::unique_ptr<std::string_view[]>> Mango::StringPool::_ownedPages;
+// Empty handle is a view of an empty literal, so it's null-terminated as every other view
+std::string_view Mango::StringPool::_firstPage[Mango::StringPool::PageSize]{ std::string_view("", 0) };
+std::array<std::string_view*, Mango::StringPool::MaxPages> Mango::StringPool::_pages{ Mango::StringPool::_firstPage };
+uint32_t Mango::StringPool::_count = 1;
+std::unordered_map<std::string_view, Mango::StringHandle> Mango::StringPool::_handles;
+
+Mango::StringHandle Mango::StringPool::Intern(std::string_view string)
+{
+	if (string.empty())
+	{
+		return EmptyHandle;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _handles.find(string);
+	if (it != _handles.end())
+	{
+		return it->second;
+	}
+
+	const auto handle = _count;
+	const auto page = handle >> PageShift;
+	M_ASSERT(page < MaxPages && "String pool is full");
+	if (_pages[page] == nullptr)
+	{
+		_pages[page] = _ownedPages.emplace_back(std::make_unique<std::string_view[]>(PageSize)).get();
+	}
+
+	std::string_view stored(Store(string), string.size());
+	_pages[page][handle & PageMask] = stored;
+	_handles.emplace(stored, handle);
+	_count++;
+	return handle;
+}
+
+bool Mango::StringPool::Find(std::string_view string, Mango::StringHandle* handle)
+{
+	if (string.empty())
+	{
+		*handle = EmptyHandle;
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _handles.find(string);
+	if (it == _handles.end())
+	{
+		return false;
+	}
+
+	*handle = it->second;
+	return true;
+}
+
+const char* Mango::StringPool::Store(std::string_view string)
+{
+	const auto size = string.size() + 1;
+
+	// Strings that don't fit into regular block get a dedicated one
+	if (size > BlockSize)
+	{
+		auto& block = _blocks.emplace_back(std::make_unique<char[]>(size));
+		std::memcpy(block.get(), string.data(), string.size());
+		block[string.size()] = '\0';
+		return block.get();
+	}
+
+	if (_blockOffset + size > BlockSize)
+	{
+		_currentBlock = _blocks.emplace_back(std::make_unique<char[]>(BlockSize)).get();
+		_blockOffset = 0;
+	}
+
+	char* destination = _currentBlock + _blockOffset;
+	std::memcpy(destination, string.data(), string.size());
+	destination[string.size()] = '\0';
+	_blockOffset += size;
+	return destination;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Mango
+{
+	typedef uint32_t StringHandle;
+
+	// Global pool of interned strings. Equal strings always share the same handle,
+	// so handles could be compared and hashed instead of the strings themselves.
+	// Strings are copied into large arena blocks, they are never freed and their memory never moves.
+	// Handle 0 is always an empty string, so default constructed handles are valid.
+	class StringPool
+	{
+	public:
+		StringPool() = delete;
+		StringPool(const StringPool&) = delete;
+		StringPool operator=(const StringPool&) = delete;
+
+		static constexpr Mango::StringHandle EmptyHandle = 0;
+
+		// Returns handle of specified string, string is added to the pool if it wasn't interned yet
+		static Mango::StringHandle Intern(std::string_view string);
+
+		// Looks up handle of already interned string. Never allocates
+		static bool Find(std::string_view string, Mango::StringHandle* handle);
+
+		// Returned view is null-terminated, so its data() could be passed to C APIs.
+		// Handle table pages are never reallocated, so lookup doesn't need a lock
+		static std::string_view Get(Mango::StringHandle handle) { return _pages[handle >> PageShift][handle & PageMask]; }
+
+	private:
+		static constexpr uint32_t PageShift = 12;
+		static constexpr uint32_t PageSize = 1 << PageShift;
+		static constexpr uint32_t PageMask = PageSize - 1;
+		static constexpr uint32_t MaxPages = 1 << 12;
+		static constexpr size_t BlockSize = 64 * 1024;
+
+		static std::mutex _mutex;
+		static std::vector<std::unique_ptr<char[]>> _blocks;
+		static char* _currentBlock;
+		static size_t _blockOffset;
+		static std::vector<std::unique_ptr<std::string_view[]>> _ownedPages;
+		static std::string_view _firstPage[PageSize];
+		static std::array<std::string_view*, MaxPages> _pages;
+		static uint32_t _count;
+		static std::unordered_map<std::string_view, Mango::StringHandle> _handles;
+
+		static const char* Store(std::string_view string);
+	};
+}
@@ -0,0 +1,306 @@
+#include "TransformStore.h"
+
+#include "../Infrastructure/Jobs/JobSystem.h"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define M_TRANSFORM_STORE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define M_TRANSFORM_STORE_SSE2
+#endif
+
+namespace
+{
+	// Thin wrappers over SIMD registers, so composition kernel is written only once for every instruction set
+#if defined(M_TRANSFORM_STORE_AVX2)
+	typedef __m256 Lane;
+	typedef __m256i IntLane;
+	constexpr size_t LaneWidth = 8;
+
+	inline Lane Load(const float* memory) { return _mm256_loadu_ps(memory); }
+	inline void Store(float* memory, Lane value) { _mm256_storeu_ps(memory, value); }
+	inline Lane Set(float value) { return _mm256_set1_ps(value); }
+	inline Lane Add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+	inline Lane Sub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+	inline Lane Mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+	inline Lane And(Lane a, Lane b) { return _mm256_and_ps(a, b); }
+	inline Lane AndNot(Lane a, Lane b) { return _mm256_andnot_ps(a, b); }
+	inline Lane Xor(Lane a, Lane b) { return _mm256_xor_ps(a, b); }
+	inline IntLane SetInt(int value) { return _mm256_set1_epi32(value); }
+	inline IntLane ToInt(Lane value) { return _mm256_cvttps_epi32(value); }
+	inline Lane ToFloat(IntLane value) { return _mm256_cvtepi32_ps(value); }
+	inline IntLane AddInt(IntLane a, IntLane b) { return _mm256_add_epi32(a, b); }
+	inline IntLane SubInt(IntLane a, IntLane b) { return _mm256_sub_epi32(a, b); }
+	inline IntLane AndInt(IntLane a, IntLane b) { return _mm256_and_si256(a, b); }
+	inline IntLane AndNotInt(IntLane a, IntLane b) { return _mm256_andnot_si256(a, b); }
+	inline IntLane EqualInt(IntLane a, IntLane b) { return _mm256_cmpeq_epi32(a, b); }
+	inline IntLane ShiftLeftInt(IntLane value, int count) { return _mm256_slli_epi32(value, count); }
+	inline Lane AsFloat(IntLane value) { return _mm256_castsi256_ps(value); }
+#elif defined(M_TRANSFORM_STORE_SSE2)
+	typedef __m128 Lane;
+	typedef __m128i IntLane;
+	constexpr size_t LaneWidth = 4;
+
+	inline Lane Load(const float* memory) { return _mm_loadu_ps(memory); }
+	inline void Store(float* memory, Lane value) { _mm_storeu_ps(memory, value); }
+	inline Lane Set(float value) { return _mm_set1_ps(value); }
+	inline Lane Add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+	inline Lane Sub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+	inline Lane Mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+	inline Lane And(Lane a, Lane b) { return _mm_and_ps(a, b); }
+	inline Lane AndNot(Lane a, Lane b) { return _mm_andnot_ps(a, b); }
+	inline Lane Xor(Lane a, Lane b) { return _mm_xor_ps(a, b); }
+	inline IntLane SetInt(int value) { return _mm_set1_epi32(value); }
+	inline IntLane ToInt(Lane value) { return _mm_cvttps_epi32(value); }
+	inline Lane ToFloat(IntLane value) { return _mm_cvtepi32_ps(value); }
+	inline IntLane AddInt(IntLane a, IntLane b) { return _mm_add_epi32(a, b); }
+	inline IntLane SubInt(IntLane a, IntLane b) { return _mm_sub_epi32(a, b); }
+	inline IntLane AndInt(IntLane a, IntLane b) { return _mm_and_si128(a, b); }
+	inline IntLane AndNotInt(IntLane a, IntLane b) { return _mm_andnot_si128(a, b); }
+	inline IntLane EqualInt(IntLane a, IntLane b) { return _mm_cmpeq_epi32(a, b); }
+	inline IntLane ShiftLeftInt(IntLane value, int count) { return _mm_slli_epi32(value, count); }
+	inline Lane AsFloat(IntLane value) { return _mm_castsi128_ps(value); }
+#else
+	typedef float Lane;
+	constexpr size_t LaneWidth = 1;
+
+	inline Lane Load(const float* memory) { return *memory; }
+	inline void Store(float* memory, Lane value) { *memory = value; }
+	inline Lane Set(float value) { return value; }
+	inline Lane Add(Lane a, Lane b) { return a + b; }
+	inline Lane Sub(Lane a, Lane b) { return a - b; }
+	inline Lane Mul(Lane a, Lane b) { return a * b; }
+#endif
+
+#if defined(M_TRANSFORM_STORE_AVX2) || defined(M_TRANSFORM_STORE_SSE2)
+	// Vectorized sine and cosine based on Cephes library polynomials, accurate to float precision in [-8192, 8192] range
+	inline void SinCos(Lane x, Lane* sine, Lane* cosine)
+	{
+		const Lane signMask = AsFloat(SetInt(static_cast<int>(0x80000000)));
+
+		Lane sineSign = And(x, signMask);
+		x = AndNot(signMask, x);
+
+		// Scale by 4/Pi and round to the even octant
+		Lane y = Mul(x, Set(1.27323954473516f));
+		IntLane octant = ToInt(y);
+		octant = AndInt(AddInt(octant, SetInt(1)), SetInt(~1));
+		y = ToFloat(octant);
+
+		const Lane sineSwapSign = AsFloat(ShiftLeftInt(AndInt(octant, SetInt(4)), 29));
+		const Lane polynomialMask = AsFloat(EqualInt(AndInt(octant, SetInt(2)), SetInt(0)));
+		const Lane cosineSign = AsFloat(ShiftLeftInt(AndNotInt(SubInt(octant, SetInt(2)), SetInt(4)), 29));
+		sineSign = Xor(sineSign, sineSwapSign);
+
+		// Extended precision modular arithmetic: x = ((x - y * DP1) - y * DP2) - y * DP3
+		x = Sub(x, Mul(y, Set(0.78515625f)));
+		x = Sub(x, Mul(y, Set(2.4187564849853515625e-4f)));
+		x = Sub(x, Mul(y, Set(3.77489497744594108e-8f)));
+
+		const Lane z = Mul(x, x);
+
+		// Cosine polynomial for the first octant
+		Lane cosinePolynomial = Set(2.443315711809948e-5f);
+		cosinePolynomial = Add(Mul(cosinePolynomial, z), Set(-1.388731625493765e-3f));
+		cosinePolynomial = Add(Mul(cosinePolynomial, z), Set(4.166664568298827e-2f));
+		cosinePolynomial = Mul(Mul(cosinePolynomial, z), z);
+		cosinePolynomial = Sub(cosinePolynomial, Mul(z, Set(0.5f)));
+		cosinePolynomial = Add(cosinePolynomial, Set(1.0f));
+
+		// Sine polynomial for the first octant
+		Lane sinePolynomial = Set(-1.9515295891e-4f);
+		sinePolynomial = Add(Mul(sinePolynomial, z), Set(8.3321608736e-3f));
+		sinePolynomial = Add(Mul(sinePolynomial, z), Set(-1.6666654611e-1f));
+		sinePolynomial = Add(Mul(Mul(sinePolynomial, z), x), x);
+
+		// Select polynomials according to the octant
+		const Lane sineFromSine = And(polynomialMask, sinePolynomial);
+		const Lane sineFromCosine = AndNot(polynomialMask, cosinePolynomial);
+		const Lane cosineFromSine = Sub(sinePolynomial, sineFromSine);
+		const Lane cosineFromCosine = Sub(cosinePolynomial, sineFromCosine);
+
+		*sine = Xor(Add(sineFromSine, sineFromCosine), sineSign);
+		*cosine = Xor(Add(cosineFromSine, cosineFromCosine), cosineSign);
+	}
+#else
+	inline void SinCos(Lane x, Lane* sine, Lane* cosine)
+	{
+		*sine = std::sin(x);
+		*cosine = std::cos(x);
+	}
+#endif
+
+	// Number of kernel iterations processed by a single job
+	constexpr size_t ComposeGrainSize = 256;
+
+	// Compose T * R * S matrices for LaneWidth transforms starting at index.
+	// Rotation is built the same way as glm::toMat4(glm::quat(eulerRadians)) does it.
+	void ComposeLanes(
+		const float* translationX, const float* translationY, const float* translationZ,
+		const float* rotationX, const float* rotationY, const float* rotationZ,
+		const float* scaleX, const float* scaleY, const float* scaleZ,
+		size_t index,
+		float* output)
+	{
+		// Degrees to radians and half angles for quaternion at once
+		const Lane halfAngle = Set(3.14159265358979323846f / 360.0f);
+		Lane sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCos(Mul(Load(rotationX + index), halfAngle), &sinX, &cosX);
+		SinCos(Mul(Load(rotationY + index), halfAngle), &sinY, &cosY);
+		SinCos(Mul(Load(rotationZ + index), halfAngle), &sinZ, &cosZ);
+
+		const Lane cosXcosY = Mul(cosX, cosY);
+		const Lane sinXsinY = Mul(sinX, sinY);
+		const Lane sinXcosY = Mul(sinX, cosY);
+		const Lane cosXsinY = Mul(cosX, sinY);
+
+		const Lane w = Add(Mul(cosXcosY, cosZ), Mul(sinXsinY, sinZ));
+		const Lane x = Sub(Mul(sinXcosY, cosZ), Mul(cosXsinY, sinZ));
+		const Lane y = Add(Mul(cosXsinY, cosZ), Mul(sinXcosY, sinZ));
+		const Lane z = Sub(Mul(cosXcosY, sinZ), Mul(sinXsinY, cosZ));
+
+		const Lane two = Set(2.0f);
+		const Lane one = Set(1.0f);
+		const Lane xx = Mul(x, x);
+		const Lane yy = Mul(y, y);
+		const Lane zz = Mul(z, z);
+		const Lane xy = Mul(x, y);
+		const Lane xz = Mul(x, z);
+		const Lane yz = Mul(y, z);
+		const Lane wx = Mul(w, x);
+		const Lane wy = Mul(w, y);
+		const Lane wz = Mul(w, z);
+
+		const Lane sx = Load(scaleX + index);
+		const Lane sy = Load(scaleY + index);
+		const Lane sz = Load(scaleZ + index);
+
+		// Column major matrix elements, rotation columns are multiplied by scale
+		alignas(32) float columns[16][LaneWidth];
+		Store(columns[0], Mul(Sub(one, Mul(two, Add(yy, zz))), sx));
+		Store(columns[1], Mul(Mul(two, Add(xy, wz)), sx));
+		Store(columns[2], Mul(Mul(two, Sub(xz, wy)), sx));
+		Store(columns[3], Set(0.0f));
+		Store(columns[4], Mul(Mul(two, Sub(xy, wz)), sy));
+		Store(columns[5], Mul(Sub(one, Mul(two, Add(xx, zz))), sy));
+		Store(columns[6], Mul(Mul(two, Add(yz, wx)), sy));
+		Store(columns[7], Set(0.0f));
+		Store(columns[8], Mul(Mul(two, Add(xz, wy)), sz));
+		Store(columns[9], Mul(Mul(two, Sub(yz, wx)), sz));
+		Store(columns[10], Mul(Sub(one, Mul(two, Add(xx, yy))), sz));
+		Store(columns[11], Set(0.0f));
+		Store(columns[12], Load(translationX + index));
+		Store(columns[13], Load(translationY + index));
+		Store(columns[14], Load(translationZ + index));
+		Store(columns[15], one);
+
+		// Transpose lanes back into separate matrices
+		for (size_t lane = 0; lane < LaneWidth; lane++)
+		{
+			float* matrix = output + (index + lane) * 16;
+			for (size_t element = 0; element < 16; element++)
+			{
+				matrix[element] = columns[element][lane];
+			}
+		}
+	}
+}
+
+void Mango::TransformStore::Clear()
+{
+	_size = 0;
+	_translationX.clear();
+	_translationY.clear();
+	_translationZ.clear();
+	_rotationX.clear();
+	_rotationY.clear();
+	_rotationZ.clear();
+	_scaleX.clear();
+	_scaleY.clear();
+	_scaleZ.clear();
+}
+
+void Mango::TransformStore::Reserve(size_t count)
+{
+	const size_t capacity = count + LaneWidth;
+	_translationX.reserve(capacity);
+	_translationY.reserve(capacity);
+	_translationZ.reserve(capacity);
+	_rotationX.reserve(capacity);
+	_rotationY.reserve(capacity);
+	_rotationZ.reserve(capacity);
+	_scaleX.reserve(capacity);
+	_scaleY.reserve(capacity);
+	_scaleZ.reserve(capacity);
+	_transforms.reserve(capacity);
+}
+
+void Mango::TransformStore::Add(glm::vec3 translation, glm::vec3 rotation, glm::vec3 scale)
+{
+	_translationX.push_back(translation.x);
+	_translationY.push_back(translation.y);
+	_translationZ.push_back(translation.z);
+	_rotationX.push_back(rotation.x);
+	_rotationY.push_back(rotation.y);
+	_rotationZ.push_back(rotation.z);
+	_scaleX.push_back(scale.x);
+	_scaleY.push_back(scale.y);
+	_scaleZ.push_back(scale.z);
+	_size++;
+}
+
+void Mango::TransformStore::Compose()
+{
+	if (_size == 0)
+	{
+		return;
+	}
+
+	// Pad arrays to the whole number of lanes, so kernel never needs a scalar tail
+	const size_t paddedSize = (_size + LaneWidth - 1) / LaneWidth * LaneWidth;
+	_translationX.resize(paddedSize, 0.0f);
+	_translationY.resize(paddedSize, 0.0f);
+	_translationZ.resize(paddedSize, 0.0f);
+	_rotationX.resize(paddedSize, 0.0f);
+	_rotationY.resize(paddedSize, 0.0f);
+	_rotationZ.resize(paddedSize, 0.0f);
+	_scaleX.resize(paddedSize, 1.0f);
+	_scaleY.resize(paddedSize, 1.0f);
+	_scaleZ.resize(paddedSize, 1.0f);
+	_transforms.resize(paddedSize);
+
+	// Batches are independent, so they are composed on all job system threads
+	float* output = &_transforms[0][0][0];
+	Mango::JobSystem::ParallelFor(paddedSize / LaneWidth, ComposeGrainSize, [this, output](size_t begin, size_t end)
+	{
+		for (size_t batch = begin; batch < end; batch++)
+		{
+			ComposeLanes(
+				_translationX.data(), _translationY.data(), _translationZ.data(),
+				_rotationX.data(), _rotationY.data(), _rotationZ.data(),
+				_scaleX.data(), _scaleY.data(), _scaleZ.data(),
+				batch * LaneWidth,
+				output
+			);
+		}
+	});
+
+	// Drop padding, so values could be added after composition
+	_translationX.resize(_size);
+	_translationY.resize(_size);
+	_translationZ.resize(_size);
+	_rotationX.resize(_size);
+	_rotationY.resize(_size);
+	_rotationZ.resize(_size);
+	_scaleX.resize(_size);
+	_scaleY.resize(_size);
+	_scaleZ.resize(_size);
+}
+
+size_t Mango::TransformStore::GetBatchSize()
+{
+	return LaneWidth;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace Mango
+{
+	// Structure of arrays storage of translation, rotation and scale values.
+	// Transform matrices for all stored values are composed in batches with SIMD instructions,
+	// 8 transforms at a time with AVX2, 4 transforms at a time with SSE2. Batches are spread over job system threads.
+	class TransformStore
+	{
+	public:
+		TransformStore() = default;
+		TransformStore(const TransformStore&) = delete;
+		TransformStore operator=(const TransformStore&) = delete;
+
+		void Clear();
+		void Reserve(size_t count);
+
+		// Rotation in degrees, same as in TransformComponent
+		void Add(glm::vec3 translation, glm::vec3 rotation, glm::vec3 scale);
+
+		// Compose transform matrices for all added values. Produces the same result as TransformComponent::GetTransform
+		void Compose();
+
+		inline size_t GetSize() const { return _size; }
+		inline const glm::mat4& GetTransform(size_t index) const { return _transforms[index]; }
+
+		// Number of transforms composed by a single kernel iteration
+		static size_t GetBatchSize();
+
+	private:
+		size_t _size = 0;
+
+		std::vector<float> _translationX;
+		std::vector<float> _translationY;
+		std::vector<float> _translationZ;
+		std::vector<float> _rotationX;
+		std::vector<float> _rotationY;
+		std::vector<float> _rotationZ;
+		std::vector<float> _scaleX;
+		std::vector<float> _scaleY;
+		std::vector<float> _scaleZ;
+
+		std::vector<glm::mat4> _transforms;
+	};
+}
@@ -0,0 +1,408 @@
+#include "WorldStreamer.h"
+
+#include "Scene.h"
+#include "SceneSerializer.h"
+#include "Components/Components.h"
+#include "../Infrastructure/IO/FileReader.h"
+#include "../Infrastructure/Logging/Logging.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+Mango::WorldStreamer::WorldStreamer(Mango::Scene& scene, const std::filesystem::path& manifestPath)
+	: _scene(scene), _manifestPath(manifestPath)
+{
+	ReadManifest();
+	_loaderThread = std::thread(&Mango::WorldStreamer::RunLoader, this);
+}
+
+Mango::WorldStreamer::~WorldStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopRequested = true;
+	}
+	_condition.notify_one();
+	_loaderThread.join();
+
+	// Entities of loaded chunks stay in scene, only staging scenes are disposed
+	for (const auto& loadedChunk : _loadedChunks)
+	{
+		delete loadedChunk.Scene;
+	}
+	for (auto scene : _retiredScenes)
+	{
+		delete scene;
+	}
+}
+
+void Mango::WorldStreamer::Update()
+{
+	glm::ivec2 center;
+	if (!GetStreamingCenter(&center))
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::swap(_chunksToMerge, _loadedChunks);
+	}
+
+	// Chunk could leave unload radius while it was loading, such chunk is dropped without touching scene
+	for (const auto& [chunkIndex, chunkScene] : _chunksToMerge)
+	{
+		if (_chunkStates[chunkIndex] != ChunkState::Requested)
+		{
+			continue;
+		}
+
+		if (chunkScene == nullptr)
+		{
+			_chunkStates[chunkIndex] = ChunkState::Failed;
+		}
+		else if (GetDistance(_chunks[chunkIndex].Coordinates, center) <= _unloadRadius)
+		{
+			MergeChunk(*chunkScene, chunkIndex);
+			_chunkStates[chunkIndex] = ChunkState::Loaded;
+			_loadedChunksCount++;
+		}
+		else
+		{
+			_chunkStates[chunkIndex] = ChunkState::Unloaded;
+		}
+	}
+
+	// Requests that left unload radius before loader got to them are cancelled
+	_chunksToUnload.clear();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const auto& loadedChunk : _chunksToMerge)
+		{
+			if (loadedChunk.Scene != nullptr)
+			{
+				_retiredScenes.push_back(loadedChunk.Scene);
+			}
+		}
+
+		std::erase_if(_activeChunks, [this, center](uint32_t chunkIndex)
+		{
+			if (_chunkStates[chunkIndex] == ChunkState::Unloaded || _chunkStates[chunkIndex] == ChunkState::Failed)
+			{
+				return true;
+			}
+			if (GetDistance(_chunks[chunkIndex].Coordinates, center) <= _unloadRadius)
+			{
+				return false;
+			}
+
+			if (_chunkStates[chunkIndex] == ChunkState::Loaded)
+			{
+				_chunksToUnload.push_back(chunkIndex);
+				return true;
+			}
+
+			auto request = std::find(_requests.begin(), _requests.end(), chunkIndex);
+			if (request != _requests.end())
+			{
+				_requests.erase(request);
+				_chunkStates[chunkIndex] = ChunkState::Unloaded;
+				return true;
+			}
+			return false;
+		});
+	}
+	_chunksToMerge.clear();
+	UnloadChunks();
+
+	// Chunks nearest to camera are requested first
+	_chunksToRequest.clear();
+	for (int32_t y = center.y - _loadRadius; y <= center.y + _loadRadius; y++)
+	{
+		for (int32_t x = center.x - _loadRadius; x <= center.x + _loadRadius; x++)
+		{
+			auto chunk = _chunksByCoordinates.find(GetCoordinatesKey(glm::ivec2(x, y)));
+			if (chunk != _chunksByCoordinates.end() && _chunkStates[chunk->second] == ChunkState::Unloaded)
+			{
+				_chunksToRequest.push_back(chunk->second);
+			}
+		}
+	}
+	if (_chunksToRequest.empty())
+	{
+		return;
+	}
+
+	std::sort(_chunksToRequest.begin(), _chunksToRequest.end(), [this, center](uint32_t first, uint32_t second)
+	{
+		return GetDistance(_chunks[first].Coordinates, center) < GetDistance(_chunks[second].Coordinates, center);
+	});
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto chunkIndex : _chunksToRequest)
+		{
+			_chunkStates[chunkIndex] = ChunkState::Requested;
+			_activeChunks.push_back(chunkIndex);
+			_requests.push_back(chunkIndex);
+		}
+	}
+	_condition.notify_one();
+}
+
+void Mango::WorldStreamer::SyncLoadedChunks()
+{
+	// Requested chunks stay requested, their results are merged only if chunk isn't loaded already
+	for (auto& state : _chunkStates)
+	{
+		if (state == ChunkState::Loaded)
+		{
+			state = ChunkState::Unloaded;
+		}
+	}
+
+	_loadedChunksCount = 0;
+	for (auto [_, chunk] : _scene._registry.view<ChunkComponent>().each())
+	{
+		const auto chunkIndex = chunk.GetChunkIndex();
+		if (chunkIndex < _chunkStates.size() && _chunkStates[chunkIndex] != ChunkState::Loaded)
+		{
+			_chunkStates[chunkIndex] = ChunkState::Loaded;
+			_loadedChunksCount++;
+		}
+	}
+
+	_activeChunks.clear();
+	for (uint32_t chunkIndex = 0; chunkIndex < _chunkStates.size(); chunkIndex++)
+	{
+		if (_chunkStates[chunkIndex] == ChunkState::Requested || _chunkStates[chunkIndex] == ChunkState::Loaded)
+		{
+			_activeChunks.push_back(chunkIndex);
+		}
+	}
+}
+
+void Mango::WorldStreamer::ReadManifest()
+{
+	auto manifestJson = Mango::FileReader::ReadAllText(_manifestPath);
+	auto json = nlohmann::json::parse(manifestJson);
+	if (!json.contains("chunks"))
+	{
+		throw std::runtime_error("World manifest " + _manifestPath.string() + " has no chunks");
+	}
+
+	// Streaming settings are optional
+	if (json.contains("chunkSize"))
+	{
+		_chunkSize = json["chunkSize"];
+	}
+	if (json.contains("loadRadius"))
+	{
+		_loadRadius = json["loadRadius"];
+	}
+	_unloadRadius = _loadRadius + 1;
+	if (json.contains("unloadRadius"))
+	{
+		_unloadRadius = std::max<int32_t>(json["unloadRadius"], _loadRadius);
+	}
+	if (_chunkSize <= 0.0f || _loadRadius < 0)
+	{
+		throw std::runtime_error("World manifest " + _manifestPath.string() + " has invalid streaming settings");
+	}
+
+	const auto chunksDirectory = _manifestPath.parent_path();
+	for (const auto& chunkJson : json["chunks"])
+	{
+		Mango::WorldChunk chunk;
+		chunk.Coordinates = glm::ivec2(chunkJson["coordinates"][0], chunkJson["coordinates"][1]);
+		chunk.FilePath = chunksDirectory / chunkJson["file"].get<std::string>();
+
+		const auto chunkIndex = static_cast<uint32_t>(_chunks.size());
+		if (!_chunksByCoordinates.emplace(GetCoordinatesKey(chunk.Coordinates), chunkIndex).second)
+		{
+			M_WARN("World chunk " << chunk.Coordinates.x << ", " << chunk.Coordinates.y << " is listed more than once");
+			continue;
+		}
+		_chunks.push_back(chunk);
+	}
+	_chunkStates.resize(_chunks.size(), ChunkState::Unloaded);
+}
+
+void Mango::WorldStreamer::RunLoader()
+{
+	std::vector<Mango::Scene*> retiredScenes;
+	while (true)
+	{
+		uint32_t chunkIndex = 0;
+		bool hasRequest = false;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this]() { return _stopRequested || !_requests.empty() || !_retiredScenes.empty(); });
+			if (_stopRequested)
+			{
+				return;
+			}
+
+			std::swap(retiredScenes, _retiredScenes);
+			if (!_requests.empty())
+			{
+				chunkIndex = _requests.front();
+				_requests.pop_front();
+				hasRequest = true;
+			}
+		}
+
+		// Merged and dropped staging scenes are destroyed here, so main thread doesn't pay for their teardown
+		for (auto scene : retiredScenes)
+		{
+			delete scene;
+		}
+		retiredScenes.clear();
+
+		if (!hasRequest)
+		{
+			continue;
+		}
+
+		// Staging scene has no script engine, nothing but this thread touches it until it's merged.
+		// Failed chunk is reported with null scene and isn't requested again
+		const auto& filePath = _chunks[chunkIndex].FilePath;
+		Mango::Scene* scene = new Mango::Scene(_scene._renderer);
+		try
+		{
+			Mango::SceneSerializer serializer;
+			// Chunk is decoded on this thread only, so streaming never competes with frame jobs for workers
+			serializer.PopulateFromFile(*scene, filePath, nullptr, false);
+		}
+		catch (const std::exception& ex)
+		{
+			M_ERROR("Unable to load world chunk " << filePath.string() << ": " << ex.what());
+			delete scene;
+			scene = nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_loadedChunks.push_back({ chunkIndex, scene });
+	}
+}
+
+bool Mango::WorldStreamer::GetStreamingCenter(glm::ivec2* center)
+{
+	// World is streamed around the camera scene is currently rendered from
+	const bool isPlaying = _scene._sceneState == Mango::SceneState::Play;
+	for (auto [_, camera, transform] : _scene._registry.view<CameraComponent, TransformComponent>().each())
+	{
+		if (isPlaying ? camera.IsPrimary() : camera.IsEditorCamera())
+		{
+			const auto translation = transform.GetTranslation();
+			*center = glm::ivec2(static_cast<int32_t>(std::floor(translation.x / _chunkSize)), static_cast<int32_t>(std::floor(translation.y / _chunkSize)));
+			return true;
+		}
+	}
+	return false;
+}
+
+void Mango::WorldStreamer::MergeChunk(Mango::Scene& chunkScene, uint32_t chunkIndex)
+{
+	auto& source = chunkScene._registry;
+	auto& target = _scene._registry;
+	_mergedEntities.clear();
+
+	// Cameras belong to scene, chunks only bring their content
+	for (auto [sourceEntity, id, name, transform] : source.view<IdComponent, NameComponent, TransformComponent>().each())
+	{
+		if (source.all_of<CameraComponent>(sourceEntity))
+		{
+			continue;
+		}
+
+		// Chunk could be authored with GUIDs used by scene or by another chunk
+		Mango::GUID entityId = id.GetId();
+		if (_scene.GetEntityById(entityId) != entt::null)
+		{
+			entityId = Mango::GUID();
+		}
+
+		const auto entity = target.create();
+		_mergedEntities[sourceEntity] = entity;
+		target.emplace<IdComponent>(entity, entityId);
+		target.emplace<NameComponent>(entity, name);
+		target.emplace<TransformComponent>(entity, transform.GetTranslation(), transform.GetRotation(), transform.GetScale());
+		target.emplace<ChunkComponent>(entity, chunkIndex);
+
+		if (auto color = source.try_get<ColorComponent>(sourceEntity); color != nullptr)
+		{
+			target.emplace<ColorComponent>(entity, color->GetColor());
+		}
+		if (auto geometry = source.try_get<GeometryComponent>(sourceEntity); geometry != nullptr)
+		{
+			target.emplace<GeometryComponent>(entity, geometry->GetGeometry());
+		}
+
+		// Bodies of staging scene live in its own world, so every rigidbody gets a new body in scene world
+		if (auto rigidbody = source.try_get<RigidbodyComponent>(sourceEntity); rigidbody != nullptr)
+		{
+			_scene.AddRigidbody(entity);
+			_scene.SetRigidbodyType(entity, rigidbody->GetType());
+		}
+
+		if (auto script = source.try_get<ScriptComponent>(sourceEntity); script != nullptr)
+		{
+			target.emplace<ScriptComponent>(entity, *script);
+
+			// Chunks loaded while scene is playing queue their scripts, instances are created on next script update
+			auto scriptPath = _scene._scriptPaths.find(std::string(script->GetFileName()));
+			if (_scene._sceneState == Mango::SceneState::Play && scriptPath != _scene._scriptPaths.end())
+			{
+				_scene._scriptEngine->AttachScript(entityId, scriptPath->second);
+			}
+		}
+	}
+
+	// Parents are remapped to merged entities, links to entities outside of chunk are dropped
+	for (auto [sourceEntity, relationship] : source.view<RelationshipComponent>().each())
+	{
+		auto entity = _mergedEntities.find(sourceEntity);
+		auto parent = _mergedEntities.find(relationship.GetParent());
+		if (entity != _mergedEntities.end() && parent != _mergedEntities.end())
+		{
+			_scene.SetEntityParent(entity->second, parent->second);
+		}
+	}
+}
+
+void Mango::WorldStreamer::UnloadChunks()
+{
+	if (_chunksToUnload.empty())
+	{
+		return;
+	}
+
+	for (auto chunkIndex : _chunksToUnload)
+	{
+		_chunkStates[chunkIndex] = ChunkState::Unloaded;
+	}
+	_loadedChunksCount -= _chunksToUnload.size();
+
+	// Entities are destroyed in one batch at the next sync point of scene
+	for (auto [entity, chunk] : _scene._registry.view<ChunkComponent>().each())
+	{
+		if (chunk.GetChunkIndex() < _chunkStates.size() && _chunkStates[chunk.GetChunkIndex()] == ChunkState::Unloaded)
+		{
+			_scene.DeleteEntity(entity);
+		}
+	}
+	_chunksToUnload.clear();
+}
+
+uint64_t Mango::WorldStreamer::GetCoordinatesKey(glm::ivec2 coordinates)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(coordinates.x)) << 32) | static_cast<uint32_t>(coordinates.y);
+}
+
+int32_t Mango::WorldStreamer::GetDistance(glm::ivec2 first, glm::ivec2 second)
+{
+	return std::max(std::abs(first.x - second.x), std::abs(first.y - second.y));
+}
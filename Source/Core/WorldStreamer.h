@@ -0,0 +1,105 @@
+#pragma once
+
+#include <entt/entity/registry.hpp>
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Mango
+{
+	class Scene;
+
+	// Spatial chunk of streamed world, its file is a scene saved by SceneSerializer
+	struct WorldChunk
+	{
+		glm::ivec2 Coordinates;
+		std::filesystem::path FilePath;
+	};
+
+	// Streams chunks of a large world into scene around the camera scene is rendered from.
+	// Chunk files are read and built into staging scenes on a background thread, built chunks are added to scene at frame start.
+	// Chunks further than unload radius are removed, so only chunks around camera are kept in memory
+	class WorldStreamer
+	{
+	public:
+		// World manifest lists chunk files and chunk size, chunk files are relative to manifest
+		WorldStreamer(Mango::Scene& scene, const std::filesystem::path& manifestPath);
+		WorldStreamer(const WorldStreamer&) = delete;
+		WorldStreamer operator=(const WorldStreamer&) = delete;
+		~WorldStreamer();
+
+		// Called on main thread at frame start, when no views of scene registry are alive
+		void Update();
+		// Rebuild loaded chunks from chunk components after all scene entities were replaced
+		void SyncLoadedChunks();
+
+		inline const std::filesystem::path& GetManifestPath() const { return _manifestPath; }
+		inline size_t GetChunksCount() const { return _chunks.size(); }
+		inline size_t GetLoadedChunksCount() const { return _loadedChunksCount; }
+
+	private:
+		enum class ChunkState
+		{
+			Unloaded,
+			Requested,
+			Loaded,
+			// Chunk file couldn't be loaded, it's never requested again
+			Failed
+		};
+
+		// Staging scene built by loader thread
+		struct LoadedChunk
+		{
+			uint32_t ChunkIndex;
+			Mango::Scene* Scene;
+		};
+
+	private:
+		Mango::Scene& _scene;
+		std::filesystem::path _manifestPath;
+		std::vector<Mango::WorldChunk> _chunks;
+		std::vector<ChunkState> _chunkStates;
+		std::unordered_map<uint64_t, uint32_t> _chunksByCoordinates;
+		// Requested and loaded chunks, only these are checked against unload radius
+		std::vector<uint32_t> _activeChunks;
+		size_t _loadedChunksCount = 0;
+
+		// Chunks are squares of world units, radiuses are measured in chunks
+		float _chunkSize = 64.0f;
+		int32_t _loadRadius = 1;
+		int32_t _unloadRadius = 2;
+
+		// Loader thread, guarded by mutex
+		std::thread _loaderThread;
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		std::deque<uint32_t> _requests;
+		std::vector<LoadedChunk> _loadedChunks;
+		std::vector<Mango::Scene*> _retiredScenes;
+		bool _stopRequested = false;
+
+		// Reused every frame
+		std::vector<LoadedChunk> _chunksToMerge;
+		std::vector<uint32_t> _chunksToRequest;
+		std::vector<uint32_t> _chunksToUnload;
+		std::unordered_map<entt::entity, entt::entity> _mergedEntities;
+
+	private:
+		void ReadManifest();
+		void RunLoader();
+		// Returns false if scene has no camera to stream around
+		bool GetStreamingCenter(glm::ivec2* center);
+		// Copy entities of staging scene into scene, GUIDs already used by scene are replaced with new ones
+		void MergeChunk(Mango::Scene& chunkScene, uint32_t chunkIndex);
+		void UnloadChunks();
+		static uint64_t GetCoordinatesKey(glm::ivec2 coordinates);
+		static int32_t GetDistance(glm::ivec2 first, glm::ivec2 second);
+	};
+}
@@ -2,9 +2,10 @@
 
 #include "../Infrastructure/IO/FileDialog.h"
 #include "../Core/SceneManager.h"
-#include "../Infrastructure/IO/FileWriter.h"
-#include "../Infrastructure/IO/FileReader.h"
+#include "../Infrastructure/Logging/Logging.h"
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 
 Mango::ImGuiEditor::ImGuiEditor(const Window* window)
@@ -35,43 +36,72 @@ void Mango::ImGuiEditor::ConstructEditor()
 	{
 		if (ImGui::BeginMenu("File"))
 		{
-			if (ImGui::MenuItem("Open", "Ctrl+O"))
+			if (ImGui::MenuItem("Open", "Ctrl+O", false, !Mango::SceneManager::IsLoading()))
 			{
 				// Bug: Add entity, Play, Stop, Remove Entity, Play, Stop - Crash
 
 				Mango::FileDialog fileDialog;
 				std::filesystem::path filePath;
-				const auto succeeded = fileDialog.Open(&filePath, { { L"JSON (*.json)", L"*.json" } });
+				const auto succeeded = fileDialog.Open(&filePath, { { L"Mango scene (*.mscene)", L"*.mscene" }, { L"JSON (*.json)", L"*.json" } });
 				if (!succeeded)
 				{
 					goto cancelled;
 				}
 
-				auto sceneJson = Mango::FileReader::ReadAllText(filePath);
-				Mango::SceneManager::LoadFromJson(sceneJson);
-				InitializeSceneForEditor();
+				// Loaded scene is swapped in by application at the start of a frame
+				Mango::SceneManager::LoadFromFileAsync(filePath);
 			}
 
 			if (ImGui::MenuItem("Save as...", "Ctrl+Alt+S"))
 			{
 				Mango::FileDialog fileDialog;
 				std::filesystem::path filePath;
-				const auto succeeded = fileDialog.Save(&filePath, { { L"JSON (*.json)", L"*.json" } }, L"json");
+				const auto succeeded = fileDialog.Save(&filePath, { { L"Mango scene (*.mscene)", L"*.mscene" }, { L"JSON (*.json)", L"*.json" } }, L"mscene");
 				if (!succeeded)
 				{
 					goto cancelled;
 				}
 
+				// JSON is kept as interchange and debug format, binary scenes load much faster
 				Mango::SceneSerializer serializer;
-				const auto serializedScene = serializer.Serialize(Mango::SceneManager::GetScene());
+				serializer.SerializeToFile(Mango::SceneManager::GetScene(), filePath);
+			}
+
+			ImGui::Separator();
+			if (ImGui::MenuItem("Open world..."))
+			{
+				Mango::FileDialog fileDialog;
+				std::filesystem::path manifestPath;
+				const auto succeeded = fileDialog.Open(&manifestPath, { { L"JSON (*.json)", L"*.json" } });
+				if (!succeeded)
+				{
+					goto cancelled;
+				}
 
-				// Open Save File Dialog here
-				Mango::FileWriter::WriteFile(filePath, serializedScene);
+				// Chunks around camera are streamed in while scene is updated
+				try
+				{
+					Mango::SceneManager::GetScene().OpenWorld(manifestPath);
+				}
+				catch (const std::exception& ex)
+				{
+					M_ERROR("Unable to open world " << manifestPath.string() << ": " << ex.what());
+				}
+			}
+
+			if (ImGui::MenuItem("Close world", nullptr, false, Mango::SceneManager::GetScene().GetWorldStreamer() != nullptr))
+			{
+				Mango::SceneManager::GetScene().CloseWorld();
 			}
 
 		cancelled:
 			ImGui::EndMenu();
 		}
+
+		if (Mango::SceneManager::IsLoading())
+		{
+			ImGui::ProgressBar(Mango::SceneManager::GetLoadProgress(), ImVec2(200.0f, 0.0f), "Loading scene...");
+		}
 		ImGui::EndMenuBar();
 	}
 
@@ -114,8 +144,7 @@ void Mango::ImGuiEditor::ConstructEditor()
 	{
 		if (Mango::SceneManager::GetScene().GetSceneState() != Mango::SceneState::Play)
 		{
-			Mango::SceneSerializer serializer;
-			_sceneState = serializer.Serialize(Mango::SceneManager::GetScene());
+			_sceneSnapshot.Capture(Mango::SceneManager::GetScene());
 		}
 
 		Mango::SceneManager::GetScene().OnPlay();
@@ -123,9 +152,12 @@ void Mango::ImGuiEditor::ConstructEditor()
 	ImGui::SameLine();
 	if (ImGui::Button(stopText, { secondButtonWidth, buttonsHeight }))
 	{
-		Mango::SceneManager::GetScene().OnStop();
-		Mango::SceneManager::LoadFromJson(_sceneState);
-		InitializeSceneForEditor();
+		if (!_sceneSnapshot.IsEmpty())
+		{
+			Mango::SceneManager::GetScene().OnStop();
+			_sceneSnapshot.Restore(Mango::SceneManager::GetScene());
+			InitializeSceneForEditor();
+		}
 	}
 	ImGui::End();
 	ImGui::PopStyleVar();
@@ -227,7 +259,7 @@ void Mango::ImGuiEditor::ConstructEditor()
 	{
 		ImGui::PushID(id.GetId());
 		auto entitySelected = entity == _selectedEntity;
-		if (ImGui::Selectable(name.GetName(), entitySelected))
+		if (ImGui::Selectable(name.GetName().data(), entitySelected))
 		{
 			_selectedEntity = entity;
 		}
@@ -288,7 +320,17 @@ void Mango::ImGuiEditor::ConstructEditor()
 		ImGui::PushID(id.GetId());
 
 		// NameComponent
-		ImGui::InputText("Name", name.GetName(), name.GetBufferSize());
+		// Scratch buffer is refreshed only while it's not edited, name is interned once editing is finished
+		if (!_nameEditActive)
+		{
+			CopyToBuffer(name.GetName(), _nameBuffer, sizeof(_nameBuffer));
+		}
+		ImGui::InputText("Name", _nameBuffer, sizeof(_nameBuffer));
+		_nameEditActive = ImGui::IsItemActive();
+		if (ImGui::IsItemDeactivatedAfterEdit())
+		{
+			Mango::SceneManager::GetScene().SetEntityName(_selectedEntity, _nameBuffer);
+		}
 
 		// TransformComponent
 		float transformDragSpeed = 0.1f;
@@ -363,10 +405,12 @@ void Mango::ImGuiEditor::ConstructEditor()
 		auto rigidbody = Mango::SceneManager::GetScene().GetRegistry().try_get<RigidbodyComponent>(_selectedEntity);
 		if (rigidbody != nullptr)
 		{
-			bool isDynamic = rigidbody->IsDynamic();
-			if (ImGui::Checkbox("Is Dynamic", &isDynamic))
+			// Items are in order of rigidbody type values
+			const char* bodyTypes[] = { "Static", "Dynamic", "Kinematic" };
+			int bodyType = static_cast<int>(rigidbody->GetType());
+			if (ImGui::Combo("Body Type", &bodyType, bodyTypes, IM_ARRAYSIZE(bodyTypes)))
 			{
-				rigidbody->SetDynamic(isDynamic);
+				Mango::SceneManager::GetScene().SetRigidbodyType(_selectedEntity, static_cast<Mango::RigidbodyType>(bodyType));
 			}
 		}
 
@@ -374,7 +418,16 @@ void Mango::ImGuiEditor::ConstructEditor()
 		auto script = Mango::SceneManager::GetScene().GetRegistry().try_get<ScriptComponent>(_selectedEntity);
 		if (script != nullptr)
 		{
-			ImGui::InputText("Script", script->GetFileName(), script->GetBufferSize());
+			if (!_scriptFileNameEditActive)
+			{
+				CopyToBuffer(script->GetFileName(), _scriptFileNameBuffer, sizeof(_scriptFileNameBuffer));
+			}
+			ImGui::InputText("Script", _scriptFileNameBuffer, sizeof(_scriptFileNameBuffer));
+			_scriptFileNameEditActive = ImGui::IsItemActive();
+			if (ImGui::IsItemDeactivatedAfterEdit())
+			{
+				script->SetFileName(_scriptFileNameBuffer);
+			}
 		}
 
 		ImGui::PopID();
@@ -410,7 +463,7 @@ void Mango::ImGuiEditor::ConstructEditor()
 	ImGui::End();
 }
 
-void Mango::ImGuiEditor::NewFrame(uint32_t currentFrame)
+void Mango::ImGuiEditor::NewFrame()
 {
 	ImGui::NewFrame();
 }
@@ -430,8 +483,18 @@ inline float Mango::ImGuiEditor::GetCameraMovementSpeed()
 	return 0.01f;
 }
 
+void Mango::ImGuiEditor::CopyToBuffer(std::string_view string, char* buffer, size_t bufferSize)
+{
+	const auto size = std::min(string.size(), bufferSize - 1);
+	std::memcpy(buffer, string.data(), size);
+	buffer[size] = '\0';
+}
+
 void Mango::ImGuiEditor::InitializeSceneForEditor()
 {
+	// Scene is either new or restored, there is no play session to return from
+	_sceneSnapshot.Clear();
+
 	bool editorCameraExist = false;
 	for (const auto& [entity, camera] : Mango::SceneManager::GetScene().GetRegistry().view<CameraComponent>().each())
 	{
@@ -446,10 +509,10 @@ void Mango::ImGuiEditor::InitializeSceneForEditor()
 	if (!editorCameraExist)
 	{
 		_editorCamera = Mango::SceneManager::GetScene().AddCamera(); // Editor scene will always have an editor camera
-		auto [id, camera, transform, name] = Mango::SceneManager::GetScene().GetRegistry().get<IdComponent, CameraComponent, TransformComponent, NameComponent>(_editorCamera);
+		auto [id, camera, transform] = Mango::SceneManager::GetScene().GetRegistry().get<IdComponent, CameraComponent, TransformComponent>(_editorCamera);
 		camera.SetEditorCamera(true);
 		camera.SetPrimary(true);
-		name.SetName("Editor Camera");
+		Mango::SceneManager::GetScene().SetEntityName(_editorCamera, "Editor Camera");
 		auto currentTranslation = transform.GetTranslation();
 		transform.SetTranslation({ currentTranslation.x, currentTranslation.y, 5.0f });
 		transform.SetRotation({ 0.0f, 0.0f, 0.0f });
@@ -3,11 +3,13 @@
 #include "../Core/GUID.h"
 #include "../Windowing/Window.h"
 #include "../Core/SceneSerializer.h"
+#include "../Core/SceneSnapshot.h"
 
 #include <imgui.h>
 #include <glm/glm.hpp>
 
 #include <string>
+#include <string_view>
 
 namespace Mango
 {
@@ -21,7 +23,7 @@ namespace Mango
 		void InitializeSceneForEditor();
 		const glm::vec2 GetViewportSize() const { return _viewportSize; };
 
-		virtual void NewFrame(uint32_t currentFrame);
+		virtual void NewFrame();
 		virtual void EndFrame();
 
 	protected:
@@ -31,13 +33,21 @@ namespace Mango
 	private:
 		entt::entity _selectedEntity;
 		entt::entity _editorCamera;
-		std::string _sceneState;
+		// Scene as it was before play, restored on stop
+		Mango::SceneSnapshot _sceneSnapshot;
 		
 		bool _viewportCameraMoveStarted = false;
 		ImVec2 _viewportCameraMoveStartMousePosition;
 
+		// Components keep only string handles, text inputs edit scratch buffers instead
+		char _nameBuffer[128] = {};
+		char _scriptFileNameBuffer[128] = {};
+		bool _nameEditActive = false;
+		bool _scriptFileNameEditActive = false;
+
 	private:
 		inline float GetCameraRotationSpeed();
 		inline float GetCameraMovementSpeed();
+		static void CopyToBuffer(std::string_view string, char* buffer, size_t bufferSize);
 	};
 }
@@ -28,3 +28,29 @@ void Mango::FileWriter::WriteFile(const std::filesystem::path& filepath, const s
     file.write(text.c_str(), text.size());
     file.close();
 }
+
+void Mango::FileWriter::WriteFile(const std::filesystem::path& filepath, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream file(filepath, std::ios::trunc | std::ios::binary);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open file: " + filepath.string());
+    }
+
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    file.close();
+}
+
+void Mango::FileWriter::WriteFile(const std::filesystem::path& filepath, const std::function<void(std::ostream&)>& write)
+{
+    std::ofstream file(filepath, std::ios::trunc);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open file: " + filepath.string());
+    }
+
+    write(file);
+    file.close();
+}
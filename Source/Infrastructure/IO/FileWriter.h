@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <ostream>
 #include <string>
+#include <vector>
 
 namespace Mango
 {
@@ -25,5 +29,21 @@ namespace Mango
 		/// <param name="filepath">Path to file</param>
 		/// <param name="text">Text to write to file</param>
 		static void WriteFile(const std::filesystem::path& filepath, const std::string& text);
+
+		/// <summary>
+		/// Write bytes to specified file path. File is created if it doesn't exist.
+		/// File contents would be overriden.
+		/// </summary>
+		/// <param name="filepath">Path to file</param>
+		/// <param name="bytes">Bytes to write to file</param>
+		static void WriteFile(const std::filesystem::path& filepath, const std::vector<uint8_t>& bytes);
+
+		/// <summary>
+		/// Open specified file path for writing and let callback write into it. File is created if it doesn't exist.
+		/// File contents would be overriden.
+		/// </summary>
+		/// <param name="filepath">Path to file</param>
+		/// <param name="write">Callback that writes file contents into stream</param>
+		static void WriteFile(const std::filesystem::path& filepath, const std::function<void(std::ostream&)>& write);
 	};
 }
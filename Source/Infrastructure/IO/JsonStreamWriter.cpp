@@ -0,0 +1,165 @@
+#include "JsonStreamWriter.h"
+
+#include <charconv>
+#include <cmath>
+
+Mango::JsonStreamWriter::JsonStreamWriter(std::ostream& stream, int32_t indent)
+    : _stream(stream), _indent(indent)
+{
+}
+
+void Mango::JsonStreamWriter::BeginObject()
+{
+    BeginValue();
+    _stream.put('{');
+    _counts.push_back(0);
+}
+
+void Mango::JsonStreamWriter::EndObject()
+{
+    const bool isEmpty = _counts.back() == 0;
+    _counts.pop_back();
+    if (!isEmpty)
+    {
+        NewLine(_counts.size());
+    }
+    _stream.put('}');
+}
+
+void Mango::JsonStreamWriter::BeginArray()
+{
+    BeginValue();
+    _stream.put('[');
+    _counts.push_back(0);
+}
+
+void Mango::JsonStreamWriter::EndArray()
+{
+    const bool isEmpty = _counts.back() == 0;
+    _counts.pop_back();
+    if (!isEmpty)
+    {
+        NewLine(_counts.size());
+    }
+    _stream.put(']');
+}
+
+void Mango::JsonStreamWriter::Key(std::string_view key)
+{
+    BeginValue();
+    WriteString(key);
+    _stream.write(": ", 2);
+    _afterKey = true;
+}
+
+void Mango::JsonStreamWriter::Value(std::string_view value)
+{
+    BeginValue();
+    WriteString(value);
+}
+
+void Mango::JsonStreamWriter::Value(bool value)
+{
+    BeginValue();
+    _stream << (value ? "true" : "false");
+}
+
+void Mango::JsonStreamWriter::Value(int64_t value)
+{
+    BeginValue();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    _stream.write(buffer, result.ptr - buffer);
+}
+
+void Mango::JsonStreamWriter::Value(uint64_t value)
+{
+    BeginValue();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    _stream.write(buffer, result.ptr - buffer);
+}
+
+void Mango::JsonStreamWriter::Value(float value)
+{
+    BeginValue();
+    if (!std::isfinite(value))
+    {
+        _stream << "null";
+        return;
+    }
+
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    _stream.write(buffer, result.ptr - buffer);
+}
+
+void Mango::JsonStreamWriter::BeginValue()
+{
+    // Value of object member goes on the same line as its key
+    if (_afterKey)
+    {
+        _afterKey = false;
+        return;
+    }
+    if (_counts.empty())
+    {
+        return;
+    }
+
+    if (_counts.back() > 0)
+    {
+        _stream.put(',');
+    }
+    _counts.back()++;
+    NewLine(_counts.size());
+}
+
+void Mango::JsonStreamWriter::NewLine(size_t depth)
+{
+    _stream.put('\n');
+    for (size_t i = 0; i < depth * _indent; i++)
+    {
+        _stream.put(' ');
+    }
+}
+
+void Mango::JsonStreamWriter::WriteString(std::string_view string)
+{
+    static constexpr char hexDigits[] = "0123456789abcdef";
+
+    _stream.put('"');
+    for (char character : string)
+    {
+        switch (character)
+        {
+        case '"':
+            _stream.write("\\\"", 2);
+            break;
+        case '\\':
+            _stream.write("\\\\", 2);
+            break;
+        case '\n':
+            _stream.write("\\n", 2);
+            break;
+        case '\r':
+            _stream.write("\\r", 2);
+            break;
+        case '\t':
+            _stream.write("\\t", 2);
+            break;
+        default:
+            if (static_cast<unsigned char>(character) < 0x20)
+            {
+                const char escaped[] = { '\\', 'u', '0', '0', hexDigits[character >> 4], hexDigits[character & 0xF] };
+                _stream.write(escaped, sizeof(escaped));
+            }
+            else
+            {
+                _stream.put(character);
+            }
+            break;
+        }
+    }
+    _stream.put('"');
+}
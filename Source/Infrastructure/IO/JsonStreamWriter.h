@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace Mango
+{
+	// Writes pretty-printed JSON straight into output stream, nothing but nesting of containers is kept in memory.
+	// Object members are written as Key followed by a value or a container
+	class JsonStreamWriter
+	{
+	public:
+		JsonStreamWriter(std::ostream& stream, int32_t indent = 4);
+		JsonStreamWriter(const JsonStreamWriter&) = delete;
+		JsonStreamWriter operator=(const JsonStreamWriter&) = delete;
+
+		void BeginObject();
+		void EndObject();
+		void BeginArray();
+		void EndArray();
+		void Key(std::string_view key);
+
+		void Value(std::string_view value);
+		void Value(const char* value) { Value(std::string_view(value)); }
+		void Value(bool value);
+		void Value(int64_t value);
+		void Value(uint64_t value);
+		void Value(int32_t value) { Value(static_cast<int64_t>(value)); }
+		void Value(uint32_t value) { Value(static_cast<uint64_t>(value)); }
+		// Written with the shortest representation that reads back to the same value, NaN and infinity are written as null
+		void Value(float value);
+
+	private:
+		std::ostream& _stream;
+		int32_t _indent;
+		// Number of values written into every open container
+		std::vector<size_t> _counts;
+		bool _afterKey = false;
+
+	private:
+		// Separator and indentation before value in current container
+		void BeginValue();
+		void NewLine(size_t depth);
+		void WriteString(std::string_view string);
+	};
+}
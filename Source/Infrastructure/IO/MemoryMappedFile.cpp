@@ -0,0 +1,116 @@
+#include "MemoryMappedFile.h"
+
+#include <stdexcept>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef WIN32
+Mango::MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& filepath)
+{
+    HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open file: " + filepath.string());
+    }
+    _file = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to get size of file: " + filepath.string());
+    }
+    _size = static_cast<size_t>(fileSize.QuadPart);
+
+    // Empty file can't be mapped, it's exposed as empty view instead
+    if (_size == 0)
+    {
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map file: " + filepath.string());
+    }
+    _mapping = mapping;
+
+    _data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map file: " + filepath.string());
+    }
+}
+
+Mango::MemoryMappedFile::~MemoryMappedFile()
+{
+    if (_data != nullptr)
+    {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping != nullptr)
+    {
+        CloseHandle(_mapping);
+    }
+    if (_file != nullptr)
+    {
+        CloseHandle(_file);
+    }
+}
+#else
+Mango::MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& filepath)
+{
+    _file = open(filepath.c_str(), O_RDONLY);
+    if (_file == -1)
+    {
+        throw std::runtime_error("Failed to open file: " + filepath.string());
+    }
+
+    struct stat fileStat;
+    if (fstat(_file, &fileStat) == -1)
+    {
+        close(_file);
+        throw std::runtime_error("Failed to get size of file: " + filepath.string());
+    }
+    _size = static_cast<size_t>(fileStat.st_size);
+
+    // Empty file can't be mapped, it's exposed as empty view instead
+    if (_size == 0)
+    {
+        return;
+    }
+
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+    if (data == MAP_FAILED)
+    {
+        close(_file);
+        throw std::runtime_error("Failed to map file: " + filepath.string());
+    }
+    _data = static_cast<const uint8_t*>(data);
+
+    // File is read front to back once
+    madvise(data, _size, MADV_SEQUENTIAL);
+}
+
+Mango::MemoryMappedFile::~MemoryMappedFile()
+{
+    if (_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    if (_file != -1)
+    {
+        close(_file);
+    }
+}
+#endif
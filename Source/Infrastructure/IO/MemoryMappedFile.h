@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace Mango
+{
+	// Read-only view of whole file mapped into memory. Pages are loaded by OS on first access,
+	// so large files could be read without copying them into a buffer first
+	class MemoryMappedFile
+	{
+	public:
+		MemoryMappedFile(const std::filesystem::path& filepath);
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile operator=(const MemoryMappedFile&) = delete;
+		~MemoryMappedFile();
+
+		inline const uint8_t* GetData() const { return _data; }
+		inline size_t GetSize() const { return _size; }
+
+	private:
+		const uint8_t* _data = nullptr;
+		size_t _size = 0;
+
+#ifdef WIN32
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+#else
+		int _file = -1;
+#endif
+	};
+}
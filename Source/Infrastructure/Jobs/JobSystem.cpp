@@ -0,0 +1,210 @@
+#include "JobSystem.h"
+
+#include "../Assert/Assert.h"
+
+#include <algorithm>
+
+std::vector<std::unique_ptr<Mango::JobSystem::JobQueue>> Mango::JobSystem::_queues;
+std::vector<std::thread> Mango::JobSystem::_workers;
+std::atomic<bool> Mango::JobSystem::_running = false;
+std::atomic<uint32_t> Mango::JobSystem::_queuedJobsCount = 0;
+std::mutex Mango::JobSystem::_wakeMutex;
+std::condition_variable Mango::JobSystem::_wakeCondition;
+thread_local uint32_t Mango::JobSystem::_queueIndex = Mango::JobSystem::ExternalQueue;
+
+void Mango::JobSystem::Initialize(uint32_t workersCount)
+{
+    M_ASSERT(!_running && "Job system is already initialized");
+
+    if (workersCount == 0)
+    {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workersCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    _queueIndex = MainQueue;
+    for (uint32_t i = 0; i < workersCount + 2; i++)
+    {
+        _queues.push_back(std::make_unique<JobQueue>());
+    }
+
+    _running = true;
+    for (uint32_t i = 0; i < workersCount; i++)
+    {
+        _workers.emplace_back(RunWorker, i + 2);
+    }
+}
+
+void Mango::JobSystem::Shutdown()
+{
+    if (!_running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _running = false;
+    }
+    _wakeCondition.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+    _queues.clear();
+    _queuedJobsCount = 0;
+}
+
+uint32_t Mango::JobSystem::GetThreadsCount()
+{
+    return static_cast<uint32_t>(_workers.size()) + 1;
+}
+
+void Mango::JobSystem::Submit(Mango::Job job, Mango::JobCounter* counter)
+{
+    if (!_running)
+    {
+        job();
+        return;
+    }
+
+    QueuedJob queuedJob{ std::move(job), counter };
+
+    if (counter != nullptr)
+    {
+        counter->_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Threads that don't belong to job system share the external queue
+    auto& queue = *_queues[_queueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        queue.Jobs.push_back(std::move(queuedJob));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _queuedJobsCount.fetch_add(1, std::memory_order_release);
+    }
+    _wakeCondition.notify_one();
+}
+
+void Mango::JobSystem::Wait(Mango::JobCounter& counter)
+{
+    while (!counter.IsDone())
+    {
+        if (!TryExecuteJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Mango::JobSystem::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    if (!_running || count <= grainSize)
+    {
+        func(0, count);
+        return;
+    }
+
+    // Calling thread processes the first range itself and helps with the rest while waiting
+    Mango::JobCounter counter;
+    for (size_t begin = grainSize; begin < count; begin += grainSize)
+    {
+        const size_t end = std::min(begin + grainSize, count);
+        Submit([&func, begin, end]() { func(begin, end); }, &counter);
+    }
+    func(0, grainSize);
+    Wait(counter);
+}
+
+void Mango::JobSystem::RunWorker(uint32_t queueIndex)
+{
+    _queueIndex = queueIndex;
+    while (_running)
+    {
+        if (TryExecuteJob())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wakeCondition.wait(lock, []() { return !_running || _queuedJobsCount.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+bool Mango::JobSystem::TryExecuteJob()
+{
+    if (_queuedJobsCount.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    // Own queue first. Main thread stops there, so its waits are never held up by jobs of background loaders
+    QueuedJob job;
+    bool found = TryPop(_queueIndex, false, job);
+    if (!found && _queueIndex != MainQueue)
+    {
+        // Jobs of main thread are stolen first, then the others starting with the next queue to spread contention
+        found = TryPop(MainQueue, true, job);
+        const auto queuesCount = static_cast<uint32_t>(_queues.size());
+        for (uint32_t i = 1; !found && i < queuesCount; i++)
+        {
+            const uint32_t queueIndex = (_queueIndex + i) % queuesCount;
+            if (queueIndex != MainQueue)
+            {
+                found = TryPop(queueIndex, true, job);
+            }
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+
+    _queuedJobsCount.fetch_sub(1, std::memory_order_acq_rel);
+    Execute(job);
+    return true;
+}
+
+bool Mango::JobSystem::TryPop(uint32_t queueIndex, bool steal, QueuedJob& job)
+{
+    auto& queue = *_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    if (queue.Jobs.empty())
+    {
+        return false;
+    }
+
+    // Owner takes the most recent job, which is likely still in cache. Thieves take the oldest one
+    if (steal)
+    {
+        job = std::move(queue.Jobs.front());
+        queue.Jobs.pop_front();
+    }
+    else
+    {
+        job = std::move(queue.Jobs.back());
+        queue.Jobs.pop_back();
+    }
+    return true;
+}
+
+void Mango::JobSystem::Execute(QueuedJob& job)
+{
+    job.Function();
+    if (job.Counter != nullptr)
+    {
+        job.Counter->_count.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mango
+{
+    typedef std::function<void()> Job;
+
+    // Number of submitted jobs that are not finished yet. Used to wait for a group of jobs
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter operator=(const JobCounter&) = delete;
+
+        inline bool IsDone() const { return _count.load(std::memory_order_acquire) == 0; }
+
+    private:
+        std::atomic<uint32_t> _count = 0;
+
+        friend class JobSystem;
+    };
+
+    // Engine wide pool of worker threads. Every worker owns a queue of jobs, it takes its own jobs
+    // from the back of the queue and steals jobs of other workers from the front when it runs out of work.
+    // Threads waiting for a counter execute pending jobs instead of blocking. The thread which initialized job system
+    // only executes jobs it submitted itself, so a frame never waits for background work of other threads.
+    // When job system is not initialized jobs are executed right away on calling thread
+    class JobSystem
+    {
+    public:
+        JobSystem() = delete;
+
+        // Starts workersCount threads, 0 means one worker per hardware thread except the calling one
+        static void Initialize(uint32_t workersCount = 0);
+        static void Shutdown();
+
+        // Number of threads executing jobs, including the thread which initialized job system
+        static uint32_t GetThreadsCount();
+
+        // Counter is incremented on submit and decremented once job is finished
+        static void Submit(Mango::Job job, Mango::JobCounter* counter = nullptr);
+
+        // Returns once all jobs of counter are finished
+        static void Wait(Mango::JobCounter& counter);
+
+        // Splits [0, count) into ranges of at most grainSize elements and calls func(begin, end) for each range in parallel.
+        // Returns once all ranges are processed
+        static void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func);
+
+    private:
+        struct QueuedJob
+        {
+            Mango::Job Function;
+            Mango::JobCounter* Counter;
+        };
+
+        struct JobQueue
+        {
+            std::mutex Mutex;
+            std::deque<QueuedJob> Jobs;
+        };
+
+        // Queue 0 belongs to the thread which initialized job system, queue 1 is shared by threads
+        // that don't belong to job system, other queues belong to workers
+        static constexpr uint32_t MainQueue = 0;
+        static constexpr uint32_t ExternalQueue = 1;
+        static std::vector<std::unique_ptr<JobQueue>> _queues;
+        static std::vector<std::thread> _workers;
+        static std::atomic<bool> _running;
+        static std::atomic<uint32_t> _queuedJobsCount;
+        static std::mutex _wakeMutex;
+        static std::condition_variable _wakeCondition;
+        static thread_local uint32_t _queueIndex;
+
+        static void RunWorker(uint32_t queueIndex);
+        static bool TryExecuteJob();
+        static bool TryPop(uint32_t queueIndex, bool steal, QueuedJob& job);
+        static void Execute(QueuedJob& job);
+    };
+}
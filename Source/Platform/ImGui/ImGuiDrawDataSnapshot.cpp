@@ -0,0 +1,39 @@
+#include "ImGuiDrawDataSnapshot.h"
+
+Mango::ImGuiDrawDataSnapshot::~ImGuiDrawDataSnapshot()
+{
+    Clear();
+}
+
+void Mango::ImGuiDrawDataSnapshot::Capture(const ImDrawData* drawData)
+{
+    Clear();
+
+    _drawData.Valid = drawData->Valid;
+    _drawData.TotalIdxCount = drawData->TotalIdxCount;
+    _drawData.TotalVtxCount = drawData->TotalVtxCount;
+    _drawData.DisplayPos = drawData->DisplayPos;
+    _drawData.DisplaySize = drawData->DisplaySize;
+    _drawData.FramebufferScale = drawData->FramebufferScale;
+    _drawData.OwnerViewport = drawData->OwnerViewport;
+
+    // Only command, vertex and index buffers are copied, the rest of draw list state is not needed for rendering
+    _drawLists.reserve(drawData->CmdListsCount);
+    for (int i = 0; i < drawData->CmdListsCount; i++)
+    {
+        ImDrawList* drawList = drawData->CmdLists[i]->CloneOutput();
+        _drawLists.push_back(drawList);
+        _drawData.CmdLists.push_back(drawList);
+    }
+    _drawData.CmdListsCount = drawData->CmdListsCount;
+}
+
+void Mango::ImGuiDrawDataSnapshot::Clear()
+{
+    for (ImDrawList* drawList : _drawLists)
+    {
+        IM_DELETE(drawList);
+    }
+    _drawLists.clear();
+    _drawData.Clear();
+}
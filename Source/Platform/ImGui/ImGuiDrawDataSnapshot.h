@@ -0,0 +1,28 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <vector>
+
+namespace Mango
+{
+	// Owning copy of ImGui draw data. ImGui reuses its draw lists on the next frame,
+	// so render thread draws from a snapshot while main thread builds the next frame
+	class ImGuiDrawDataSnapshot
+	{
+	public:
+		ImGuiDrawDataSnapshot() = default;
+		ImGuiDrawDataSnapshot(const ImGuiDrawDataSnapshot&) = delete;
+		ImGuiDrawDataSnapshot operator=(const ImGuiDrawDataSnapshot&) = delete;
+		~ImGuiDrawDataSnapshot();
+
+		void Capture(const ImDrawData* drawData);
+		void Clear();
+
+		ImDrawData* GetDrawData() { return &_drawData; }
+
+	private:
+		ImDrawData _drawData;
+		std::vector<ImDrawList*> _drawLists;
+	};
+}
@@ -98,6 +98,11 @@ Mango::ImGuiEditor_ImplGLFWVulkan::ImGuiEditor_ImplGLFWVulkan(ImGuiEditor_ImplGL
     _viewportTextureId = _imGuiEditorViewport->GetViewportImageDescriptorSet();
     // End initialize editor viewport texture
 
+    for (uint32_t i = 0; i < createInfo.FramePacketsCount; i++)
+    {
+        _drawDataSnapshots.push_back(std::make_unique<Mango::ImGuiDrawDataSnapshot>());
+    }
+
     // Create image transition barriers
     _toDestinationTransitionBarrier = CreateImageMemoryBarrier(
         VK_IMAGE_LAYOUT_UNDEFINED,
@@ -139,12 +144,11 @@ Mango::ImGuiEditor_ImplGLFWVulkan::~ImGuiEditor_ImplGLFWVulkan()
     ImGui_ImplGlfw_Shutdown();
 }
 
-void Mango::ImGuiEditor_ImplGLFWVulkan::NewFrame(uint32_t currentFrame)
+void Mango::ImGuiEditor_ImplGLFWVulkan::NewFrame()
 {
-    _currentFrame = currentFrame;
     ImGui_ImplVulkan_NewFrame();
     ImGui_ImplGlfw_NewFrame();
-    Mango::ImGuiEditor::NewFrame(_currentFrame);
+    Mango::ImGuiEditor::NewFrame();
 }
 
 void Mango::ImGuiEditor_ImplGLFWVulkan::EndFrame()
@@ -152,8 +156,15 @@ void Mango::ImGuiEditor_ImplGLFWVulkan::EndFrame()
     Mango::ImGuiEditor::EndFrame();
 }
 
-const Mango::CommandBuffer& Mango::ImGuiEditor_ImplGLFWVulkan::RecordCommandBuffer(uint32_t imageIndex)
+void Mango::ImGuiEditor_ImplGLFWVulkan::CaptureDrawData(uint32_t packetIndex)
+{
+    ImGui::Render();
+    _drawDataSnapshots[packetIndex]->Capture(ImGui::GetDrawData());
+}
+
+const Mango::CommandBuffer& Mango::ImGuiEditor_ImplGLFWVulkan::RecordCommandBuffer(uint32_t currentFrame, uint32_t imageIndex, uint32_t packetIndex)
 {
+    _currentFrame = currentFrame;
     const auto& currentCommandBuffer = _imGuiCommandBuffers->GetCommandBuffer(_currentFrame);
     const auto& currentFramebuffer = _imGuiFramebuffers->GetFramebuffer(imageIndex);
 
@@ -188,8 +199,7 @@ const Mango::CommandBuffer& Mango::ImGuiEditor_ImplGLFWVulkan::RecordCommandBuff
 
     currentCommandBuffer.BeginRenderPass(currentFramebuffer.GetSwapChainFramebuffer(), _renderArea);
 
-    ImGui::Render();
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), currentVkCommandBuffer);
+    ImGui_ImplVulkan_RenderDrawData(_drawDataSnapshots[packetIndex]->GetDrawData(), currentVkCommandBuffer);
 
     currentCommandBuffer.EndRenderPass();
     currentCommandBuffer.EndCommandBuffer();
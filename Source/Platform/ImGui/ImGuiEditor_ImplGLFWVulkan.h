@@ -13,6 +13,7 @@
 
 #include "../Windowing/GLFWWindow.h"
 #include "ImGuiEditorViewport_ImplVulkan.h"
+#include "ImGuiDrawDataSnapshot.h"
 
 #include "vulkan/vulkan.h"
 #include "imgui_impl_glfw.h"
@@ -31,6 +32,7 @@ namespace Mango
 		Mango::RenderAreaInfo RenderAreaInfo;
 		Mango::RenderArea ViewportRenderArea;
 		Mango::RenderAreaInfo ViewportAreaInfo;
+		uint32_t FramePacketsCount;
 	};
 
 	class ImGuiEditor_ImplGLFWVulkan : public ImGuiEditor
@@ -41,9 +43,13 @@ namespace Mango
 		ImGuiEditor_ImplGLFWVulkan operator=(const ImGuiEditor_ImplGLFWVulkan&) = delete;
 		~ImGuiEditor_ImplGLFWVulkan();
 
-		void NewFrame(uint32_t currentFrame) override;
+		void NewFrame() override;
 		void EndFrame() override;
-		const Mango::CommandBuffer& RecordCommandBuffer(uint32_t imageIndex);
+
+		// Renders ImGui frame and stores its draw data into frame packet. Called from main thread
+		void CaptureDrawData(uint32_t packetIndex);
+		// Records draw data of frame packet. Called from render thread
+		const Mango::CommandBuffer& RecordCommandBuffer(uint32_t currentFrame, uint32_t imageIndex, uint32_t packetIndex);
 
 		void HandleResize(Mango::RenderArea renderArea, Mango::RenderAreaInfo renderAreaInfo);
 		void HandleViewportResize(const Mango::RenderArea viewportRenderArea, const Mango::RenderAreaInfo viewportRenderAreaInfo);
@@ -87,7 +93,8 @@ namespace Mango
 		std::unique_ptr<Mango::CommandPool> _imGuiCommandPool;
 		std::unique_ptr<Mango::CommandBuffersPool> _imGuiCommandBuffers;
 		std::unique_ptr<Mango::ImGuiEditorViewport_ImplVulkan> _imGuiEditorViewport;
-		uint32_t _currentFrame;
+		std::vector<std::unique_ptr<Mango::ImGuiDrawDataSnapshot>> _drawDataSnapshots;
+		uint32_t _currentFrame = 0;
 
 		VkImageMemoryBarrier _toDestinationTransitionBarrier;
 		VkImageMemoryBarrier _toShaderReadTransitionBarrier;
@@ -71,6 +71,7 @@ void Mango::Buffer::ReallocateBuffer(VkDeviceSize bufferSizeBytes)
 	M_ASSERT(createBufferResult == VK_SUCCESS && "Failed to create buffer");
 
 	AllocateMemory(_physicalDevice, _requiredProperties);
+	_bufferSize = bufferSizeBytes;
 }
 
 void Mango::Buffer::AllocateMemory(const Mango::PhysicalDevice& physicalDevice, VkMemoryPropertyFlags requiredProperties)
@@ -52,43 +52,35 @@ void Mango::CommandBuffer::BeginRenderPass(const VkFramebuffer& framebuffer, con
     vkCmdSetScissor(_commandBuffer, 0, 1, &scissor);
 }
 
-void Mango::CommandBuffer::DrawIndexed(
-    const Mango::VertexBuffer& vertexBuffer,
-    const Mango::IndexBuffer& indexBuffer,
-    std::vector<uint32_t>& indicesPerDraw,
-    std::vector<uint32_t>& dynamicOffsets,
-    std::vector<VkDescriptorSet> descriptors,
-    const VkPipelineLayout& pipelineLayout
-) const
+void Mango::CommandBuffer::BindGeometry(const Mango::VertexBuffer& vertexBuffer, const Mango::IndexBuffer& indexBuffer) const
 {
-    M_ASSERT(indicesPerDraw.size() == dynamicOffsets.size() && "Indices per draw and dynamic offset arrays should have matching size");
-
     VkBuffer vertexBuffers[] = { vertexBuffer.GetBuffer() };
     VkDeviceSize offsets[] = { 0 };
-    auto descriptorSets = descriptors.data();
-    auto descriptorSetsCount = static_cast<uint32_t>(descriptors.size());
-
     vkCmdBindVertexBuffers(_commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(_commandBuffer, indexBuffer.GetBuffer(), 0, VK_INDEX_TYPE_UINT16);
+    vkCmdBindIndexBuffer(_commandBuffer, indexBuffer.GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+}
 
-    uint32_t firstIndex = 0;
-    const uint32_t drawCalls = static_cast<uint32_t>(indicesPerDraw.size());
-    for (uint32_t i = 0; i < drawCalls; i++)
+void Mango::CommandBuffer::BindDescriptorSets(const std::vector<VkDescriptorSet>& descriptors, const VkPipelineLayout& pipelineLayout) const
+{
+    vkCmdBindDescriptorSets(
+        _commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        0,
+        static_cast<uint32_t>(descriptors.size()),
+        descriptors.data(),
+        0,
+        nullptr
+    );
+}
+
+void Mango::CommandBuffer::DrawIndexedInstanced(uint32_t indicesCount, uint32_t instancesCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) const
+{
+    if (instancesCount == 0)
     {
-        vkCmdBindDescriptorSets(
-            _commandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            pipelineLayout,
-            0,
-            descriptorSetsCount,
-            descriptorSets,
-            1,
-            &dynamicOffsets[i]
-        );
-
-        vkCmdDrawIndexed(_commandBuffer, indicesPerDraw[i], 1, firstIndex, 0, 0);
-        firstIndex += indicesPerDraw[i];
+        return;
     }
+    vkCmdDrawIndexed(_commandBuffer, indicesCount, instancesCount, firstIndex, vertexOffset, firstInstance);
 }
 
 void Mango::CommandBuffer::EndRenderPass() const
@@ -25,14 +25,10 @@ namespace Mango
 
 		void BeginCommandBuffer() const;
 		void BeginRenderPass(const VkFramebuffer& framebuffer, const Mango::RenderArea renderArea) const;
-		void DrawIndexed(
-			const Mango::VertexBuffer& vertexBuffer,
-			const Mango::IndexBuffer& indexBuffer,
-			std::vector<uint32_t>& indicesPerDraw,
-			std::vector<uint32_t>& dynamicOffsets,
-			std::vector<VkDescriptorSet> descriptors,
-			const VkPipelineLayout& pipelineLayout
-		) const;
+		void BindGeometry(const Mango::VertexBuffer& vertexBuffer, const Mango::IndexBuffer& indexBuffer) const;
+		void BindDescriptorSets(const std::vector<VkDescriptorSet>& descriptors, const VkPipelineLayout& pipelineLayout) const;
+		// Draws range of bound index buffer once per instance, shaders see instances as [firstInstance, firstInstance + instancesCount)
+		void DrawIndexedInstanced(uint32_t indicesCount, uint32_t instancesCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) const;
 		void EndRenderPass() const;
 		void EndCommandBuffer() const;
 		void Reset() const;
@@ -2,7 +2,10 @@
 
 #include "../../Infrastructure/Assert/Assert.h"
 #include "../../Infrastructure/Logging/Logging.h"
+#include "../../Infrastructure/Jobs/JobSystem.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 Mango::Renderer_ImplVulkan::Renderer_ImplVulkan(const Renderer_ImplVulkan_CreateInfo createInfo)
@@ -12,6 +15,7 @@ Mango::Renderer_ImplVulkan::Renderer_ImplVulkan(const Renderer_ImplVulkan_Create
     _vulkanContext = createInfo.VulkanContext;
     _renderArea = createInfo.RenderArea;
     _renderAreaInfo = createInfo.RenderAreaInfo;
+    _framePackets.resize(createInfo.FramePacketsCount);
 
     Mango::RenderPassCreateInfo renderPassCreateInfo{};
     renderPassCreateInfo.ImageFormat = _renderAreaInfo.ImageFormat;
@@ -31,7 +35,7 @@ Mango::Renderer_ImplVulkan::Renderer_ImplVulkan(const Renderer_ImplVulkan_Create
     {
         Mango::DescriptorSetLayoutBuilder builder(*_vulkanContext->GetLogicalDevice());
         _perModelDescriptorSetLayout = builder
-            .AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT)
+            .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
             .Build();
     }
     std::vector<const Mango::DescriptorSetLayout*> layouts{ _globalDescriptorSetLayout.get(), _perModelDescriptorSetLayout.get() };
@@ -59,29 +63,41 @@ Mango::Renderer_ImplVulkan::Renderer_ImplVulkan(const Renderer_ImplVulkan_Create
         createInfo.DescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         _uniformBuffers->CreateBuffer(createInfo);
 
-        // NOTE: This could be reallocated during rendering which could slow performance
-        Mango::UniformBufferCreateInfo dynamicBufferCreateInfo{};
-        dynamicBufferCreateInfo.BufferId = static_cast<uint64_t>(i) + _maxFramesInFlight;
-        dynamicBufferCreateInfo.Binding = 0;
-        dynamicBufferCreateInfo.BufferSize = sizeof(DynamicUniformBufferObject);
-        dynamicBufferCreateInfo.DestinationSet = _descriptorPool->GetDescriptorSet(_perModelDescriptorSetLayout->GetId());
-        dynamicBufferCreateInfo.DescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-        _uniformBuffers->CreateBuffer(dynamicBufferCreateInfo);
+        _instanceStagingBuffers.push_back(std::make_unique<Mango::Buffer>(
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            sizeof(Mango::DrawItem) * _initialInstancesCapacity,
+            *_vulkanContext->GetPhysicalDevice(),
+            *_vulkanContext->GetLogicalDevice()
+        ));
     }
 
+    _instanceBuffer = std::make_unique<Mango::StorageBuffer>(sizeof(Mango::DrawItem) * _initialInstancesCapacity, *_vulkanContext->GetPhysicalDevice(), *_vulkanContext->GetLogicalDevice());
+    _uniformBuffers->UpdateDescriptorSet(*_instanceBuffer, _descriptorPool->GetDescriptorSet(_perModelDescriptorSetLayout->GetId()), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+    const uint32_t vertexCount = static_cast<uint32_t>(_geometryVertices.size());
+    const uint32_t indicesCount = static_cast<uint32_t>(_geometryIndices.size());
+    _vertexBuffer = std::make_unique<Mango::VertexBuffer>(vertexCount, sizeof(Vertex) * vertexCount, _geometryVertices.data(), *_vulkanContext->GetPhysicalDevice(), *_vulkanContext->GetLogicalDevice(), *_commandPool);
+    _indexBuffer = std::make_unique<Mango::IndexBuffer>(indicesCount, sizeof(uint32_t) * indicesCount, _geometryIndices.data(), *_vulkanContext->GetPhysicalDevice(), *_vulkanContext->GetLogicalDevice(), *_commandPool);
+
     _descriptorSets.clear();
     _descriptorSets.push_back(_descriptorPool->GetDescriptorSet(_globalDescriptorSetLayout->GetId()));
     _descriptorSets.push_back(_descriptorPool->GetDescriptorSet(_perModelDescriptorSetLayout->GetId()));
 }
 
-void Mango::Renderer_ImplVulkan::BeginFrame(uint32_t currentFrame)
+void Mango::Renderer_ImplVulkan::BeginFramePacket(uint32_t packetIndex)
 {
-    _currentFrame = currentFrame;
+    _writePacket = packetIndex;
+    auto& renderData = _framePackets[_writePacket];
+    renderData.Reset();
+    renderData.TrianglesCount = _submittedTrianglesCount;
+    renderData.RectanglesCount = _submittedRectanglesCount;
 }
 
-void Mango::Renderer_ImplVulkan::EndFrame()
+void Mango::Renderer_ImplVulkan::EndFramePacket()
 {
-    _renderData.Reset();
+    // Camera could be set while no packet is open, so it's copied only into the packet being handed over
+    _framePackets[_writePacket].Camera = _cameraInfo;
 }
 
 void Mango::Renderer_ImplVulkan::HandleResize(Mango::RenderArea renderArea, Mango::RenderAreaInfo renderAreaInfo)
@@ -102,8 +118,10 @@ void Mango::Renderer_ImplVulkan::HandleResize(Mango::RenderArea renderArea, Mang
     }
 }
 
-const Mango::CommandBuffer& Mango::Renderer_ImplVulkan::RecordCommandBuffer(uint32_t imageIndex)
+const Mango::CommandBuffer& Mango::Renderer_ImplVulkan::RecordCommandBuffer(uint32_t currentFrame, uint32_t imageIndex, uint32_t packetIndex)
 {
+    _currentFrame = currentFrame;
+    auto& renderData = _framePackets[packetIndex];
     const auto& currentCommandBuffer = _commandBuffers->GetCommandBuffer(_currentFrame);
     const auto& currentFramebuffer = _framebuffers->GetFramebuffer(imageIndex);
 
@@ -130,76 +148,77 @@ const Mango::CommandBuffer& Mango::Renderer_ImplVulkan::RecordCommandBuffer(uint
         0, 0, nullptr, 0, nullptr, 1, &memoryBarrier
     );
 
+    // Instance copies are transfer commands, so they're recorded before render pass begins
+    UpdateGlobalDescriptorSets(renderData);
+    RecordInstanceUploads(currentCommandBuffer);
+
     currentCommandBuffer.BeginRenderPass(
         currentFramebuffer.GetSwapChainFramebuffer(),
         _renderArea
     );
     currentCommandBuffer.BindPipeline(*_graphicsPipeline);
 
-    // Group all verices into buffers
-    const uint32_t vertexCount = static_cast<uint32_t>(_renderData.Vertices.size());
-    const uint32_t indicesCount = static_cast<uint32_t>(_renderData.Indices.size());
-    
-    if (vertexCount == 0)
+    // Every geometry is drawn by a single instanced call, instance index addresses its slot in instance buffer
+    const uint32_t trianglesCount = static_cast<uint32_t>(_trianglesCount);
+    const uint32_t rectanglesCount = static_cast<uint32_t>(_instances.size() - _trianglesCount);
+    if (trianglesCount + rectanglesCount > 0)
     {
-        currentCommandBuffer.EndRenderPass();
-        currentCommandBuffer.EndCommandBuffer();
-        return currentCommandBuffer;
+        currentCommandBuffer.BindGeometry(*_vertexBuffer, *_indexBuffer);
+        currentCommandBuffer.BindDescriptorSets(_descriptorSets, _graphicsPipeline->GetPipelineLayout());
+        currentCommandBuffer.DrawIndexedInstanced(_triangleIndicesCount, trianglesCount, 0, 0, 0);
+        currentCommandBuffer.DrawIndexedInstanced(_rectangleIndicesCount, rectanglesCount, _rectangleFirstIndex, _rectangleVertexOffset, trianglesCount);
     }
 
-    _vertexBuffer = std::make_unique<Mango::VertexBuffer>(vertexCount, sizeof(Vertex) * vertexCount, _renderData.Vertices.data(), *_vulkanContext->GetPhysicalDevice(), *_vulkanContext->GetLogicalDevice(), *_commandPool);
-    _indexBuffer = std::make_unique<Mango::IndexBuffer>(indicesCount, sizeof(uint16_t) * indicesCount, _renderData.Indices.data(), *_vulkanContext->GetPhysicalDevice(), *_vulkanContext->GetLogicalDevice(), *_commandPool);
-    
-    UpdateGlobalDescriptorSets();
-    UpdatePerModelDescriptorSets();
-
-    // Draw call
-    currentCommandBuffer.DrawIndexed(
-        *_vertexBuffer,
-        *_indexBuffer,
-        _renderData.IndicesPerDraw,
-        _renderData.DynamicOffsets,
-        _descriptorSets,
-        _graphicsPipeline->GetPipelineLayout()
-    );
-
     // End frame
     currentCommandBuffer.EndRenderPass();
     currentCommandBuffer.EndCommandBuffer();
     return currentCommandBuffer;
 }
 
-void Mango::Renderer_ImplVulkan::DrawRect(glm::mat4 transform, glm::vec4 color)
+void Mango::Renderer_ImplVulkan::ApplyFramePacket(uint32_t packetIndex)
 {
-    const uint32_t vertexCount = static_cast<uint32_t>(_renderData.RectangleVertices.size());
-    
-    const uint32_t lastVertexCount = _renderData.Vertices.size();
-    for (size_t i = 0; i < vertexCount; i++)
+    const auto& renderData = _framePackets[packetIndex];
+    const size_t instancesCount = renderData.TrianglesCount + renderData.RectanglesCount;
+    if (instancesCount != _instances.size())
     {
-        Mango::Vertex vertex{ _renderData.RectangleVertices[i], color };
-        _renderData.Vertices.push_back(vertex);
+        std::erase_if(_pendingSlots, [instancesCount](uint32_t slot) { return slot >= instancesCount; });
+        _instances.resize(instancesCount);
+        _pendingMask.resize(instancesCount, 0);
     }
-    for (size_t i = 0; i < _renderData.RectangleIndices.size(); i++)
+    _trianglesCount = renderData.TrianglesCount;
+
+    for (size_t i = 0; i < renderData.ChangedSlots.size(); i++)
     {
-        _renderData.Indices.push_back(lastVertexCount + _renderData.RectangleIndices[i]);
+        const uint32_t slot = renderData.ChangedSlots[i];
+        _instances[slot] = renderData.ChangedItems[i];
+        if (_pendingMask[slot] == 0)
+        {
+            _pendingMask[slot] = 1;
+            _pendingSlots.push_back(slot);
+        }
     }
-    _renderData.IndicesPerDraw.push_back(static_cast<uint32_t>(_renderData.RectangleIndices.size()));
-    _renderData.Transforms.push_back(transform);
 }
 
-void Mango::Renderer_ImplVulkan::DrawTriangle(glm::mat4 transform, glm::vec4 color)
+void Mango::Renderer_ImplVulkan::SubmitDrawList(const Mango::DrawList& drawList)
 {
-    const uint32_t vertexCount = static_cast<uint32_t>(_renderData.TriangleVertices.size());
+    auto& renderData = _framePackets[_writePacket];
+    _submittedTrianglesCount = drawList.GetTrianglesCount();
+    _submittedRectanglesCount = drawList.GetRectanglesCount();
+    renderData.TrianglesCount = _submittedTrianglesCount;
+    renderData.RectanglesCount = _submittedRectanglesCount;
 
-    const uint32_t lastVertexCount = _renderData.Vertices.size();
-    for (size_t i = 0; i < vertexCount; i++)
+    // Packet only carries changed instances, rest of them are already known by render thread
+    const auto& changedSlots = drawList.GetChangedSlots();
+    const Mango::DrawItem* items = drawList.GetItems();
+    renderData.ChangedSlots = changedSlots;
+    renderData.ChangedItems.resize(changedSlots.size());
+    Mango::JobSystem::ParallelFor(changedSlots.size(), _submitGrainSize, [&](size_t begin, size_t end)
     {
-        Mango::Vertex vertex{ _renderData.TriangleVertices[i], color };
-        _renderData.Vertices.push_back(vertex);
-        _renderData.Indices.push_back(lastVertexCount + i); // 0, 1, 2 ... 3, 4, 5 ... 6, 7, 8 ...
-    }
-    _renderData.IndicesPerDraw.push_back(static_cast<uint32_t>(_renderData.TriangleVertices.size()));
-    _renderData.Transforms.push_back(transform);
+        for (size_t i = begin; i < end; i++)
+        {
+            renderData.ChangedItems[i] = items[changedSlots[i]];
+        }
+    });
 }
 
 void Mango::Renderer_ImplVulkan::SetCamera(RendererCameraInfo cameraInfo)
@@ -207,13 +226,14 @@ void Mango::Renderer_ImplVulkan::SetCamera(RendererCameraInfo cameraInfo)
     _cameraInfo = cameraInfo;
 }
 
-void Mango::Renderer_ImplVulkan::UpdateGlobalDescriptorSets()
+void Mango::Renderer_ImplVulkan::UpdateGlobalDescriptorSets(const RenderData& renderData)
 {
+    const auto& cameraInfo = renderData.Camera;
     Mango::UniformBufferObject ubo{};
-    auto rotationQuaternion = glm::quat({ glm::radians(_cameraInfo.Rotation.x), glm::radians(_cameraInfo.Rotation.y), glm::radians(_cameraInfo.Rotation.z) });
-    ubo.View = glm::translate(glm::mat4(1.0f), _cameraInfo.Translation) * glm::toMat4(rotationQuaternion);
+    auto rotationQuaternion = glm::quat({ glm::radians(cameraInfo.Rotation.x), glm::radians(cameraInfo.Rotation.y), glm::radians(cameraInfo.Rotation.z) });
+    ubo.View = glm::translate(glm::mat4(1.0f), cameraInfo.Translation) * glm::toMat4(rotationQuaternion);
     ubo.View = glm::inverse(ubo.View);
-    ubo.Projection = glm::perspective(glm::radians(_cameraInfo.FovDegrees), _renderArea.Width / static_cast<float>(_renderArea.Height), _cameraInfo.NearPlane, _cameraInfo.FarPlane);
+    ubo.Projection = glm::perspective(glm::radians(cameraInfo.FovDegrees), _renderArea.Width / static_cast<float>(_renderArea.Height), cameraInfo.NearPlane, cameraInfo.FarPlane);
     ubo.Projection[1][1] *= -1;
 
     const auto& uniformBuffer = _uniformBuffers->GetUniformBuffer(_currentFrame);
@@ -222,28 +242,111 @@ void Mango::Renderer_ImplVulkan::UpdateGlobalDescriptorSets()
     uniformBuffer.UnmapMemory();
 }
 
-void Mango::Renderer_ImplVulkan::UpdatePerModelDescriptorSets()
+void Mango::Renderer_ImplVulkan::RecordInstanceUploads(const Mango::CommandBuffer& commandBuffer)
 {
-    const uint32_t objectsCount = static_cast<uint64_t>(_renderData.Transforms.size());
-    Mango::UniformBuffer& buffer = _uniformBuffers->GetUniformBuffer(static_cast<uint64_t>(_currentFrame) + _maxFramesInFlight);
-    const VkDeviceSize objectSize = static_cast<VkDeviceSize>(sizeof(glm::mat4));
-    const auto requiredCapacity = buffer.GetAlignedSize(objectsCount * objectSize);
-    const bool bufferResized = buffer.EnsureCapacity(requiredCapacity);
-    if (bufferResized)
+    const size_t instancesCount = _instances.size();
+    const VkDeviceSize instanceSize = static_cast<VkDeviceSize>(sizeof(Mango::DrawItem));
+    if (instancesCount == 0)
+    {
+        return;
+    }
+
+    // Instance buffer is shared by frames in flight, so it's only reallocated once device is idle. New buffer is empty and gets every instance
+    if (_instanceBuffer->GetSize() < instancesCount * instanceSize)
+    {
+        vkDeviceWaitIdle(_vulkanContext->GetLogicalDevice()->GetDevice());
+        _instanceBuffer->EnsureCapacity(instancesCount * instanceSize);
+        _uniformBuffers->UpdateDescriptorSet(*_instanceBuffer, _descriptorPool->GetDescriptorSet(_perModelDescriptorSetLayout->GetId()), 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+        _pendingSlots.resize(instancesCount);
+        for (size_t i = 0; i < instancesCount; i++)
+        {
+            _pendingSlots[i] = static_cast<uint32_t>(i);
+        }
+        std::fill(_pendingMask.begin(), _pendingMask.end(), 1);
+    }
+
+    const size_t pendingCount = _pendingSlots.size();
+    if (pendingCount == 0)
     {
-        const auto descriptorSet = _descriptorPool->GetDescriptorSet(_perModelDescriptorSetLayout->GetId());
-        _uniformBuffers->UpdateDescriptorSet(buffer, descriptorSet, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+        return;
     }
 
-    char* dynamicGpuMemory = static_cast<char*>(buffer.MapMemory());
-    const auto memoryOffset = buffer.GetAlignedSize(objectSize);
-    for (uint32_t i = 0; i < objectsCount; i++)
+    // Staging buffer of current frame is free, fence of the frame that used it last was already waited
+    auto& stagingBuffer = _instanceStagingBuffers[_currentFrame];
+    if (stagingBuffer->GetSize() < pendingCount * instanceSize)
     {
-        Mango::DynamicUniformBufferObject dUbo{};
-        dUbo.Model = _renderData.Transforms[i];
-        memcpy(dynamicGpuMemory, &dUbo, sizeof(dUbo));
-        dynamicGpuMemory += memoryOffset;
-        _renderData.DynamicOffsets.push_back(memoryOffset * i);
+        stagingBuffer = std::make_unique<Mango::Buffer>(
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            pendingCount * instanceSize + pendingCount * instanceSize / 2,
+            *_vulkanContext->GetPhysicalDevice(),
+            *_vulkanContext->GetLogicalDevice()
+        );
     }
-    buffer.UnmapMemory();
+
+    // Sorted slots are packed into staging buffer, neighbouring slots are merged into a single copy region
+    std::sort(_pendingSlots.begin(), _pendingSlots.end());
+    char* stagingMemory = static_cast<char*>(stagingBuffer->MapMemory(static_cast<uint32_t>(pendingCount * instanceSize)));
+    Mango::JobSystem::ParallelFor(pendingCount, _submitGrainSize, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            memcpy(stagingMemory + i * instanceSize, &_instances[_pendingSlots[i]], sizeof(Mango::DrawItem));
+        }
+    });
+    stagingBuffer->UnmapMemory();
+
+    _copyRegions.clear();
+    for (size_t i = 0; i < pendingCount; i++)
+    {
+        const uint32_t slot = _pendingSlots[i];
+        _pendingMask[slot] = 0;
+        if (i > 0 && slot == _pendingSlots[i - 1] + 1)
+        {
+            _copyRegions.back().size += instanceSize;
+            continue;
+        }
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = i * instanceSize;
+        copyRegion.dstOffset = slot * instanceSize;
+        copyRegion.size = instanceSize;
+        _copyRegions.push_back(copyRegion);
+    }
+    _pendingSlots.clear();
+
+    // Previous frame could still read instances in vertex shader, copy waits for it and draws of this frame wait for copy
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = _instanceBuffer->GetBuffer();
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+    bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer.GetVkCommandBuffer(),
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 1, &bufferBarrier, 0, nullptr
+    );
+
+    vkCmdCopyBuffer(
+        commandBuffer.GetVkCommandBuffer(),
+        stagingBuffer->GetBuffer(),
+        _instanceBuffer->GetBuffer(),
+        static_cast<uint32_t>(_copyRegions.size()),
+        _copyRegions.data()
+    );
+
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer.GetVkCommandBuffer(),
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0, 0, nullptr, 1, &bufferBarrier, 0, nullptr
+    );
 }
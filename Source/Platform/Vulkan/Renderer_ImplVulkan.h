@@ -14,6 +14,7 @@
 #include "GraphicsPipeline.h"
 #include "UniformBuffersPool.h"
 #include "UniformBufferObject.h"
+#include "StorageBuffer.h"
 #include "Vertex.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
@@ -28,12 +29,14 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace Mango
 {
 	struct Renderer_ImplVulkan_CreateInfo
 	{
 		uint32_t MaxFramesInFlight;
+		uint32_t FramePacketsCount;
 		Mango::RenderArea RenderArea;
 		Mango::RenderAreaInfo RenderAreaInfo;
 		const Mango::Context* VulkanContext;
@@ -47,20 +50,26 @@ namespace Mango
 		Renderer_ImplVulkan(const Renderer_ImplVulkan&) = delete;
 		Renderer_ImplVulkan operator=(const Renderer_ImplVulkan&) = delete;
 
-		void BeginFrame(uint32_t currentFrame);
-		void EndFrame();
+		// Clears frame packet and directs all following draws into it. Called from main thread
+		void BeginFramePacket(uint32_t packetIndex);
+		// Stores the last camera into frame packet before it's handed to render thread. Called from main thread
+		void EndFramePacket();
 		void HandleResize(Mango::RenderArea renderArea, Mango::RenderAreaInfo renderAreaInfo);
 
-		const Mango::CommandBuffer& RecordCommandBuffer(uint32_t imageIndex);
+		// Moves instance changes of frame packet into render thread copy of instances. Called from render thread for every packet, even dropped one
+		void ApplyFramePacket(uint32_t packetIndex);
+		// Records uploads of changed instances and draws of frame packet. Called from render thread
+		const Mango::CommandBuffer& RecordCommandBuffer(uint32_t currentFrame, uint32_t imageIndex, uint32_t packetIndex);
 
-		void DrawRect(glm::mat4 transform, glm::vec4 color) override;
-		void DrawTriangle(glm::mat4 transform, glm::vec4 color) override;
+		void SubmitDrawList(const Mango::DrawList& drawList) override;
 
 		void SetCamera(RendererCameraInfo cameraInfo) override;
 
 	private:
-		void UpdateGlobalDescriptorSets();
-		void UpdatePerModelDescriptorSets();
+		struct RenderData;
+
+		void UpdateGlobalDescriptorSets(const RenderData& renderData);
+		void RecordInstanceUploads(const Mango::CommandBuffer& commandBuffer);
 
 	private:
 		uint32_t _maxFramesInFlight;
@@ -73,7 +82,7 @@ namespace Mango
 		const std::vector<VkDescriptorPoolSize> _poolSizes = // TODO: Figure out how to allocate correct pool sizes
 		{
 			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3 },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 },
 			{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 2 }
 		};
 		std::unique_ptr<Mango::DescriptorPool> _descriptorPool;
@@ -88,32 +97,52 @@ namespace Mango
 		Mango::RenderArea _renderArea;
 		Mango::RenderAreaInfo _renderAreaInfo;
 
+		// Everything main thread submits during a frame. Render thread reads a packet while main thread writes the next one
 		struct RenderData
 		{
-			std::vector<glm::mat4> Transforms;
-			std::vector<Mango::Vertex> Vertices;
-			std::vector<uint16_t> Indices;
-			std::vector<uint32_t> DynamicOffsets;
-			std::vector<uint32_t> IndicesPerDraw;
-
-			const std::vector<glm::vec3> RectangleVertices{ {-1.0f, -1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, -1.0f, 0.0f } };
-			const std::vector<uint16_t> RectangleIndices{ 0, 1, 2, 0, 2, 3 };
-			const std::vector<glm::vec3> TriangleVertices{ {-1.0f, -1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, -1.0f, 0.0f} };
-			const std::vector<uint16_t> TriangleIndices{ 0, 1, 2 };
+			RendererCameraInfo Camera;
+			size_t TrianglesCount = 0;
+			size_t RectanglesCount = 0;
+			std::vector<uint32_t> ChangedSlots;
+			std::vector<Mango::DrawItem> ChangedItems;
 
 			void Reset()
 			{
-				Vertices.clear();
-				Indices.clear();
-				Transforms.clear();
-				DynamicOffsets.clear();
-				IndicesPerDraw.clear();
+				ChangedSlots.clear();
+				ChangedItems.clear();
 			}
 		};
-		RenderData _renderData{};
+		std::vector<RenderData> _framePackets;
+		uint32_t _writePacket = 0;
+		// Number of instances copied by a single job
+		static constexpr size_t _submitGrainSize = 4096;
+
+		// Geometry of every shape is uploaded once, triangle vertices go first and rectangle ones after
+		const std::vector<Mango::Vertex> _geometryVertices{ {{-1.0f, -1.0f, 0.0f}}, {{0.0f, 1.0f, 0.0f}}, {{1.0f, -1.0f, 0.0f}}, {{-1.0f, -1.0f, 0.0f}}, {{-1.0f, 1.0f, 0.0f}}, {{1.0f, 1.0f, 0.0f}}, {{1.0f, -1.0f, 0.0f}} };
+		const std::vector<uint32_t> _geometryIndices{ 0, 1, 2, 0, 1, 2, 0, 2, 3 };
+		static constexpr uint32_t _triangleIndicesCount = 3;
+		static constexpr uint32_t _rectangleFirstIndex = 3;
+		static constexpr uint32_t _rectangleIndicesCount = 6;
+		static constexpr int32_t _rectangleVertexOffset = 3;
 		std::unique_ptr<Mango::VertexBuffer> _vertexBuffer;
 		std::unique_ptr<Mango::IndexBuffer> _indexBuffer;
 
+		// Instances live on GPU between frames, only slots changed since last upload are copied through staging buffer of current frame
+		static constexpr size_t _initialInstancesCapacity = 1024;
+		std::unique_ptr<Mango::StorageBuffer> _instanceBuffer;
+		std::vector<std::unique_ptr<Mango::Buffer>> _instanceStagingBuffers;
+		// Render thread copy of instances, includes changes of dropped packets
+		std::vector<Mango::DrawItem> _instances;
+		size_t _trianglesCount = 0;
+		std::vector<uint32_t> _pendingSlots;
+		std::vector<uint8_t> _pendingMask;
+		std::vector<VkBufferCopy> _copyRegions;
+
+		// Instance counts persist between frames, every packet starts with the last counts submitted
+		size_t _submittedTrianglesCount = 0;
+		size_t _submittedRectanglesCount = 0;
+
+		// Camera persists between frames, every packet starts with the last camera set
 		RendererCameraInfo _cameraInfo;
 	};
 }
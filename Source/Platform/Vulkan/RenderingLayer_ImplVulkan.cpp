@@ -5,11 +5,15 @@
 
 #include <string>
 
-Mango::RenderingLayer_ImplVulkan::RenderingLayer_ImplVulkan(const Mango::Context* vulkanContext)
+Mango::RenderingLayer_ImplVulkan::RenderingLayer_ImplVulkan(const Mango::Context* vulkanContext, uint32_t maxFrameLatency)
     : _vulkanContext(vulkanContext)
 {
+    M_ASSERT((maxFrameLatency == 1 || maxFrameLatency == 2) && "Max frame latency must be 1 or 2 frames");
+
     _currentFrame = 0;
     _maxFramesInFlight = 2;
+    _maxFrameLatency = maxFrameLatency;
+    _framePacketsCount = _maxFrameLatency + 1;
     _vulkanContext = vulkanContext;
 
     _vulkanContext->GetWindow()->SetWindowUserPointer(this);
@@ -74,6 +78,7 @@ Mango::RenderingLayer_ImplVulkan::RenderingLayer_ImplVulkan(const Mango::Context
 
     Mango::Renderer_ImplVulkan_CreateInfo rendererCreateInfo{};
     rendererCreateInfo.MaxFramesInFlight = _maxFramesInFlight;
+    rendererCreateInfo.FramePacketsCount = _framePacketsCount;
     rendererCreateInfo.VulkanContext = _vulkanContext;
     rendererCreateInfo.RenderArea = _viewportRenderArea;
     rendererCreateInfo.RenderAreaInfo = _viewportRenderAreaInfo;
@@ -86,7 +91,20 @@ Mango::RenderingLayer_ImplVulkan::RenderingLayer_ImplVulkan(const Mango::Context
     editorCreateInfo.RenderAreaInfo = _screenRenderAreaInfo;
     editorCreateInfo.ViewportRenderArea = _viewportRenderArea;
     editorCreateInfo.ViewportAreaInfo = _viewportRenderAreaInfo;
+    editorCreateInfo.FramePacketsCount = _framePacketsCount;
     _editor = std::make_unique<Mango::ImGuiEditor_ImplGLFWVulkan>(editorCreateInfo);
+
+    _renderThread = std::thread(&Mango::RenderingLayer_ImplVulkan::RunRenderThread, this);
+}
+
+Mango::RenderingLayer_ImplVulkan::~RenderingLayer_ImplVulkan()
+{
+    {
+        std::lock_guard<std::mutex> lock(_framePacketsMutex);
+        _stopRenderThread = true;
+    }
+    _framePacketsCondition.notify_all();
+    _renderThread.join();
 }
 
 bool Mango::RenderingLayer_ImplVulkan::BeginFrame()
@@ -96,7 +114,13 @@ bool Mango::RenderingLayer_ImplVulkan::BeginFrame()
         return false;
     }
 
-    _editor->NewFrame(_currentFrame);
+    if (_swapChainOutOfDate)
+    {
+        FramebufferResized();
+        _swapChainOutOfDate = false;
+    }
+
+    _editor->NewFrame();
     _editor->ConstructEditor();
     const auto viewportSize = _editor->GetViewportSize();
     if (viewportSize.x != _viewportRenderArea.Width || viewportSize.y != _viewportRenderArea.Height)
@@ -121,49 +145,101 @@ bool Mango::RenderingLayer_ImplVulkan::BeginFrame()
         _viewportRenderAreaInfo.ImageViews = GetImageViews(_images);
 
         _renderer->HandleResize(_viewportRenderArea, _viewportRenderAreaInfo);
-        _renderer->EndFrame();
         _editor->HandleViewportResize(_viewportRenderArea, _viewportRenderAreaInfo);
         _editor->EndFrame();
         return false;
     }
     _editor->EndFrame();
 
-    _fences[_currentFrame]->WaitForFence();
+    // Packet of the frame that render thread could still be reading is reused only once it's rendered
+    {
+        std::unique_lock<std::mutex> lock(_framePacketsMutex);
+        _framePacketsCondition.wait(lock, [this]() { return _submittedFrames - _renderedFrames <= _maxFrameLatency; });
+        _writePacket = static_cast<uint32_t>(_submittedFrames % _framePacketsCount);
+    }
 
-    const auto nextImageResult = _swapChain->AcquireNextImage(*_imageAvailableSemaphores[_currentFrame]);
-    if (nextImageResult == VK_ERROR_OUT_OF_DATE_KHR || nextImageResult == VK_SUBOPTIMAL_KHR)
+    _renderer->BeginFramePacket(_writePacket);
+    _framePacketOpen = true;
+    return true;
+}
+
+bool Mango::RenderingLayer_ImplVulkan::EndFrame()
+{
+    if (!_framePacketOpen)
     {
-        FramebufferResized();
         return false;
     }
-    else
+
+    _renderer->EndFramePacket();
+    _editor->CaptureDrawData(_writePacket);
+    _framePacketOpen = false;
+
     {
-        M_ASSERT(nextImageResult == VK_SUCCESS && "Failed to acquire next swap chain image");
+        std::lock_guard<std::mutex> lock(_framePacketsMutex);
+        _submittedFrames++;
     }
-    _imageAcquired = true;
+    _framePacketsCondition.notify_all();
+    return true;
+}
 
-    _fences[_currentFrame]->ResetFence();
+void Mango::RenderingLayer_ImplVulkan::RunRenderThread()
+{
+    while (true)
+    {
+        uint64_t frame;
+        {
+            std::unique_lock<std::mutex> lock(_framePacketsMutex);
+            _framePacketsCondition.wait(lock, [this]() { return _stopRenderThread || _renderedFrames < _submittedFrames; });
+            if (_renderedFrames == _submittedFrames)
+            {
+                return;
+            }
+            frame = _renderedFrames;
+        }
 
-    _renderer->BeginFrame(_currentFrame);
-    return true;
+        RenderFramePacket(static_cast<uint32_t>(frame % _framePacketsCount));
+
+        {
+            std::lock_guard<std::mutex> lock(_framePacketsMutex);
+            _renderedFrames++;
+        }
+        _framePacketsCondition.notify_all();
+    }
 }
 
-bool Mango::RenderingLayer_ImplVulkan::EndFrame()
+void Mango::RenderingLayer_ImplVulkan::RenderFramePacket(uint32_t packetIndex)
 {
-    if (!_imageAcquired || _pauseRendering)
+    // Instance changes are applied even if packet is dropped, later packets only carry what changed after it
+    _renderer->ApplyFramePacket(packetIndex);
+
+    // Packets submitted after swap chain went out of date are dropped until main thread recreates it
+    if (_swapChainOutOfDate)
     {
-        return false;
+        return;
     }
 
+    _fences[_currentFrame]->WaitForFence();
+
+    const auto nextImageResult = _swapChain->AcquireNextImage(*_imageAvailableSemaphores[_currentFrame]);
+    if (nextImageResult == VK_ERROR_OUT_OF_DATE_KHR || nextImageResult == VK_SUBOPTIMAL_KHR)
+    {
+        _swapChainOutOfDate = true;
+        return;
+    }
+    else
+    {
+        M_ASSERT(nextImageResult == VK_SUCCESS && "Failed to acquire next swap chain image");
+    }
+
+    _fences[_currentFrame]->ResetFence();
+
     const uint32_t imageIndex = _swapChain->GetCurrentImageIndex();
     std::vector<VkCommandBuffer> vkCommandBuffers = 
     { 
-        _renderer->RecordCommandBuffer(imageIndex).GetVkCommandBuffer(),
-        _editor->RecordCommandBuffer(imageIndex).GetVkCommandBuffer()
+        _renderer->RecordCommandBuffer(_currentFrame, imageIndex, packetIndex).GetVkCommandBuffer(),
+        _editor->RecordCommandBuffer(_currentFrame, imageIndex, packetIndex).GetVkCommandBuffer()
     };
 
-    _renderer->EndFrame();
-
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.pCommandBuffers = vkCommandBuffers.data();
@@ -197,19 +273,24 @@ bool Mango::RenderingLayer_ImplVulkan::EndFrame()
     auto presentImageResult = vkQueuePresentKHR(_vulkanContext->GetLogicalDevice()->GetPresentationQueue(), &presentInfo);
     if (presentImageResult == VK_ERROR_OUT_OF_DATE_KHR || presentImageResult == VK_SUBOPTIMAL_KHR)
     {
-        FramebufferResized();
+        _swapChainOutOfDate = true;
     }
     else
     {
         M_ASSERT(presentImageResult == VK_SUCCESS && "Failed to acquire present swap chain image");
     }
     _currentFrame = (_currentFrame + 1) % _maxFramesInFlight;
-    _imageAcquired = false;
-    return true;
+}
+
+void Mango::RenderingLayer_ImplVulkan::WaitRenderThreadIdle()
+{
+    std::unique_lock<std::mutex> lock(_framePacketsMutex);
+    _framePacketsCondition.wait(lock, [this]() { return _renderedFrames == _submittedFrames; });
 }
 
 void Mango::RenderingLayer_ImplVulkan::WaitRenderingIdle()
 {
+    WaitRenderThreadIdle();
     vkDeviceWaitIdle(_vulkanContext->GetLogicalDevice()->GetDevice());
 
     // Fences produce validation errors somehow
@@ -227,7 +308,8 @@ void Mango::RenderingLayer_ImplVulkan::FramebufferResized()
     // Handles resize of the window framebuffer that was detected by Vulkan pipeline
     M_TRACE("Swap chain is out of date. Recreating.");
     
-    // Finish all rendering before recrating swap chain
+    // Finish all rendering before recrating swap chain, render thread must not touch it meanwhile
+    WaitRenderThreadIdle();
     for (const auto& fence : _fences)
     {
         fence->WaitForFence();
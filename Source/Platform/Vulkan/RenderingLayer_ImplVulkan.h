@@ -14,6 +14,10 @@
 
 #include <vulkan/vulkan.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <memory>
 
@@ -22,12 +26,16 @@ namespace Mango
 	class RenderingLayer_ImplVulkan : public RenderingLayer
 	{
 	public:
-		RenderingLayer_ImplVulkan(const Mango::Context* vulkanContext);
+		// Max frame latency is the number of frames main thread could run ahead of render thread, 1 or 2
+		RenderingLayer_ImplVulkan(const Mango::Context* vulkanContext, uint32_t maxFrameLatency);
 		RenderingLayer_ImplVulkan() = delete;
 		RenderingLayer_ImplVulkan(const RenderingLayer_ImplVulkan&) = delete;
 		RenderingLayer_ImplVulkan operator=(const RenderingLayer_ImplVulkan&) = delete;
+		~RenderingLayer_ImplVulkan();
 
+		// Opens frame packet for main thread. Blocks while render thread is max frame latency frames behind
 		bool BeginFrame() override;
+		// Hands frame packet over to render thread, which records, submits and presents it
 		bool EndFrame() override;
 		void WaitRenderingIdle();
 
@@ -51,12 +59,30 @@ namespace Mango
 		Mango::RenderArea _viewportRenderArea{};
 		Mango::RenderAreaInfo _viewportRenderAreaInfo{};
 
-		bool _imageAcquired = false;
 		bool _pauseRendering = false;
 
+		// Main thread writes packet of frame _submittedFrames while render thread renders packets up to it.
+		// Packets are reused in a ring of _maxFrameLatency + 1
+		uint32_t _maxFrameLatency;
+		uint32_t _framePacketsCount;
+		uint32_t _writePacket = 0;
+		bool _framePacketOpen = false;
+		uint64_t _submittedFrames = 0;
+		uint64_t _renderedFrames = 0;
+		bool _stopRenderThread = false;
+		std::mutex _framePacketsMutex;
+		std::condition_variable _framePacketsCondition;
+		std::thread _renderThread;
+
+		// Swap chain is recreated by main thread, render thread only reports it is out of date
+		std::atomic<bool> _swapChainOutOfDate = false;
+
 	private:
 		static void WindowResizedCallback(Mango::Window*, uint32_t width, uint32_t height);
 
+		void RunRenderThread();
+		void RenderFramePacket(uint32_t packetIndex);
+		void WaitRenderThreadIdle();
 		void FramebufferResized();
 		std::vector<VkImage> GetImages(std::vector<std::unique_ptr<Mango::Image>>& images);
 		std::vector<VkImageView> GetImageViews(std::vector<std::unique_ptr<Mango::Image>>& images);
@@ -0,0 +1,24 @@
+#include "StorageBuffer.h"
+
+const VkBufferUsageFlags bufferUsageFlags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+const VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+Mango::StorageBuffer::StorageBuffer(
+	VkDeviceSize bufferSizeBytes,
+	const Mango::PhysicalDevice& physicalDevice,
+	const Mango::LogicalDevice& logicalDevice
+) : Buffer(bufferUsageFlags, memoryFlags, bufferSizeBytes, physicalDevice, logicalDevice)
+{
+}
+
+bool Mango::StorageBuffer::EnsureCapacity(VkDeviceSize bufferSizeBytes)
+{
+	if (_bufferSize >= bufferSizeBytes)
+	{
+		return false;
+	}
+
+	// Allocate 1.5x times more memory to minimaze memory allocations
+	ReallocateBuffer(bufferSizeBytes + bufferSizeBytes / 2);
+	return true;
+}
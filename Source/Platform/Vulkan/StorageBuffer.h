@@ -0,0 +1,27 @@
+#pragma once
+
+#include "PhysicalDevice.h"
+#include "LogicalDevice.h"
+#include "Buffer.h"
+
+#include <vulkan/vulkan.h>
+
+namespace Mango
+{
+	// Device local buffer read by shaders, filled by transfer commands recorded into frame command buffer
+	class StorageBuffer : public Buffer
+	{
+	public:
+		StorageBuffer(
+			VkDeviceSize bufferSizeBytes,
+			const Mango::PhysicalDevice& physicalDevice,
+			const Mango::LogicalDevice& logicalDevice
+		);
+		StorageBuffer(const StorageBuffer&) = delete;
+		StorageBuffer operator=(const StorageBuffer&) = delete;
+		~StorageBuffer() = default;
+
+		// Returns true if buffer was reallocated, previous content is lost in that case
+		bool EnsureCapacity(VkDeviceSize bufferSizeBytes);
+	};
+}
@@ -10,9 +10,4 @@ namespace Mango
 		alignas(16) glm::mat4 View;
 		alignas(16) glm::mat4 Projection;
 	};
-
-	struct DynamicUniformBufferObject
-	{
-		alignas(16) glm::mat4 Model;
-	};
 }
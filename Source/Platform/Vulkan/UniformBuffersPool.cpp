@@ -41,7 +41,7 @@ uint64_t Mango::UniformBuffersPool::CreateBuffer(const UniformBufferCreateInfo c
 	return bufferId;
 }
 
-void Mango::UniformBuffersPool::UpdateDescriptorSet(Mango::UniformBuffer& buffer, VkDescriptorSet destinationSet, uint32_t binding, VkDescriptorType descriptorType)
+void Mango::UniformBuffersPool::UpdateDescriptorSet(const Mango::Buffer& buffer, VkDescriptorSet destinationSet, uint32_t binding, VkDescriptorType descriptorType)
 {
 	VkDescriptorBufferInfo bufferInfo{};
 	bufferInfo.buffer = buffer.GetBuffer();
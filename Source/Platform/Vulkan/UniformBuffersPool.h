@@ -31,7 +31,7 @@ namespace Mango
 		~UniformBuffersPool() = default;
 
 		uint64_t CreateBuffer(const Mango::UniformBufferCreateInfo createInfo);
-		void UpdateDescriptorSet(Mango::UniformBuffer& buffer, VkDescriptorSet destinationSet, uint32_t binding, VkDescriptorType descriptorType);
+		void UpdateDescriptorSet(const Mango::Buffer& buffer, VkDescriptorSet destinationSet, uint32_t binding, VkDescriptorType descriptorType);
 
 		Mango::UniformBuffer& GetUniformBuffer(uint64_t bufferId) const { return *_uniformBuffers.at(bufferId); }
 
@@ -10,7 +10,6 @@ namespace Mango
     struct Vertex
     {
         glm::vec3 Position;
-        glm::vec4 Color;
 
         static VkVertexInputBindingDescription GetBindingDescription()
         {
@@ -22,19 +21,14 @@ namespace Mango
             return bindingDescription;
         }
 
-        static std::array<VkVertexInputAttributeDescription, 2> GetAttributeDescriptions()
+        static std::array<VkVertexInputAttributeDescription, 1> GetAttributeDescriptions()
         {
-            std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+            std::array<VkVertexInputAttributeDescription, 1> attributeDescriptions{};
             attributeDescriptions[0].binding = 0;
             attributeDescriptions[0].location = 0;
             attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
             attributeDescriptions[0].offset = offsetof(Vertex, Position);
 
-            attributeDescriptions[1].binding = 0;
-            attributeDescriptions[1].location = 1;
-            attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-            attributeDescriptions[1].offset = offsetof(Vertex, Color);
-
             return attributeDescriptions;
         }
     };
@@ -0,0 +1,50 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Mango
+{
+	// Layout matches instance data read by vertex shader
+	struct DrawItem
+	{
+		glm::mat4 Transform;
+		glm::vec4 Color;
+	};
+
+	// CPU copy of scene instances. Every renderable owns a slot, triangles take [0, trianglesCount) and rectangles the rest.
+	// List persists between frames and only slots marked as changed are sent to renderer
+	class DrawList
+	{
+	public:
+		DrawList() = default;
+		DrawList(const DrawList&) = delete;
+		DrawList operator=(const DrawList&) = delete;
+
+		// Existing slots keep their items, new slots and slots given to another instance have to be written and marked as changed
+		void Resize(size_t trianglesCount, size_t rectanglesCount)
+		{
+			_trianglesCount = trianglesCount;
+			_items.resize(trianglesCount + rectanglesCount);
+		}
+
+		inline size_t GetTrianglesCount() const { return _trianglesCount; }
+		inline size_t GetRectanglesCount() const { return _items.size() - _trianglesCount; }
+		inline size_t GetInstancesCount() const { return _items.size(); }
+		inline Mango::DrawItem* GetItems() { return _items.data(); }
+		inline const Mango::DrawItem* GetItems() const { return _items.data(); }
+
+		void ClearChangedSlots() { _changedSlots.clear(); }
+		void AddChangedSlots(const std::vector<uint32_t>& slots) { _changedSlots.insert(_changedSlots.end(), slots.begin(), slots.end()); }
+		inline const std::vector<uint32_t>& GetChangedSlots() const { return _changedSlots; }
+
+	private:
+		size_t _trianglesCount = 0;
+		std::vector<Mango::DrawItem> _items;
+		std::vector<uint32_t> _changedSlots;
+	};
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "DrawList.h"
+
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 
@@ -17,8 +19,8 @@ namespace Mango
 	class Renderer
 	{
 	public:
-		virtual void DrawRect(glm::mat4 transform, glm::vec4 color) = 0;
-		virtual void DrawTriangle(glm::mat4 transform, glm::vec4 color) = 0;
+		// Sends changed slots of the list, renderer keeps the rest of instances from previous submits
+		virtual void SubmitDrawList(const Mango::DrawList& drawList) = 0;
 
 		virtual void SetCamera(RendererCameraInfo cameraInfo) = 0;
 
@@ -12,7 +12,7 @@ namespace Mango
 		// Begin new frame. Keeps frame count internally
 		virtual bool BeginFrame() = 0;
 
-		// End frame and present to screen
+		// End frame and present to screen. Presentation could happen asynchronously after this call
 		virtual bool EndFrame() = 0;
 
 	protected:
@@ -6,17 +6,23 @@ layout(set = 0, binding = 0) uniform UniformBufferObject
     mat4 proj;
 } ubo;
 
-layout(set = 1, binding = 0) uniform DynamicUniformBufferObject
+struct Instance
 {
     mat4 model;
-} dUbo;
+    vec4 color;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer InstanceBuffer
+{
+    Instance instances[];
+} instanceBuffer;
 
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec4 inColor;
 
 layout(location = 0) out vec4 fragColor;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * dUbo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
+    Instance instance = instanceBuffer.instances[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * instance.model * vec4(inPosition, 1.0);
+    fragColor = instance.color;
 }